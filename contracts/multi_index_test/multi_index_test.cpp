@@ -156,6 +156,96 @@ struct limit_order {
 
                }
                break;
+               case 2: // Test sharing of cached rows across instances and write-back mode
+               {
+                  print("Testing shared table cache and write-back.\n");
+                  typedef snax::multi_index<N(orders2), limit_order,
+                     indexed_by< N(byexp), const_mem_fun<limit_order, uint64_t, &limit_order::get_expiration> >
+                  > orders_table;
+
+                  {
+                     orders_table orders( N(multitest), N(multitest) );
+                     orders.emplace( payer, [&]( auto& o ) {
+                        o.id = 1;
+                        o.expiration = 300;
+                        o.owner = N(dan);
+                     });
+                  }
+
+                  auto read_stored = []() {
+                     auto itr = db_find_i64( N(multitest), N(multitest), N(orders2), 1 );
+                     snax_assert( itr >= 0, "row not found" );
+                     char buffer[64];
+                     auto size = db_get_i64( itr, buffer, sizeof(buffer) );
+                     snax_assert( size > 0 && size_t(size) <= sizeof(buffer), "unexpected row size" );
+                     return unpack<limit_order>( buffer, size_t(size) );
+                  };
+
+                  {
+                     orders_table orders( N(multitest), N(multitest), true );
+                     orders.set_write_back( true );
+
+                     orders_table orders2( N(multitest), N(multitest), true );
+                     const auto& order = orders.get( 1 );
+                     snax_assert( &orders2.get( 1 ) == &order, "rows are not shared between instances" );
+
+                     orders_table private_orders( N(multitest), N(multitest) );
+                     snax_assert( &private_orders.get( 1 ) != &order, "rows are shared without opting in" );
+                     orders_table private_copy( private_orders );
+                     snax_assert( &private_copy.get( 1 ) == &private_orders.get( 1 ), "rows are not shared with a copy" );
+
+                     orders2.modify( order, payer, [&]( auto& o ) {
+                        o.expiration = 400;
+                     });
+                     auto expidx = orders2.get_index<N(byexp)>();
+                     snax_assert( expidx.find( 400 ) != expidx.end(), "secondary key change was not written through" );
+                     snax_assert( read_stored().expiration == 400, "secondary key change was deferred" );
+
+                     for( uint64_t owner = N(alice); owner < N(alice) + 5; ++owner ) {
+                        orders.modify( order, payer, [&]( auto& o ) {
+                           o.owner = owner;
+                        });
+                     }
+                     snax_assert( orders2.get( 1 ).owner == N(alice) + 4, "pending modification is not visible" );
+                     snax_assert( read_stored().owner == N(dan), "modification was not deferred" );
+                  }
+
+                  snax_assert( read_stored().owner == N(alice) + 4, "row was not written back" );
+
+                  // instances can be reassigned by move
+                  orders_table moved( N(multitest), N(multitest) );
+                  moved = orders_table( N(multitest), N(multitest), true );
+                  snax_assert( moved.get( 1 ).owner == N(alice) + 4, "moved instance does not read the table" );
+               }
+               break;
+               case 3: // Benchmark: hot rows read through many short-lived instances, with private caches
+               case 4: // and with the shared cache
+               {
+                  typedef snax::multi_index<N(orders3), limit_order> orders_table;
+                  const bool shared = act.what == 4;
+                  const uint64_t rows = 16;
+                  {
+                     orders_table orders( N(multitest), N(multitest) );
+                     if( orders.begin() == orders.end() ) {
+                        for( uint64_t id = 0; id < rows; ++id ) {
+                           orders.emplace( payer, [&]( auto& o ) {
+                              o.id = id;
+                              o.expiration = id;
+                              o.owner = payer;
+                           });
+                        }
+                     }
+                  }
+
+                  // like helper functions that each open the table they need
+                  for( int i = 0; i < 200; ++i ) {
+                     orders_table orders( N(multitest), N(multitest), shared );
+                     for( uint64_t id = 0; id < rows; ++id ) {
+                        snax_assert( orders.get( id ).expiration == id, "unexpected row" );
+                     }
+                  }
+               }
+               break;
                default:
                   snax_assert(0, "Given what code is not supported.");
                break;
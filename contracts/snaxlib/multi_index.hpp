@@ -14,6 +14,7 @@
 #include <limits>
 #include <algorithm>
 #include <memory>
+#include <map>
 
 #include <boost/multi_index/mem_fun.hpp>
 
@@ -237,37 +238,77 @@ class multi_index
       uint64_t _code;
       uint64_t _scope;
 
-      mutable uint64_t _next_primary_key;
-
       enum next_primary_key_tags : uint64_t {
          no_available_primary_key = static_cast<uint64_t>(-2), // Must be the smallest uint64_t value compared to all other tags
          unset_next_primary_key = static_cast<uint64_t>(-1)
       };
 
+      struct table_cache;
+
       struct item : public T
       {
          template<typename Constructor>
-         item( const multi_index* idx, Constructor&& c )
-         :__idx(idx){
+         item( const table_cache* cache, Constructor&& c )
+         :__cache(cache){
             c(*this);
          }
 
-         const multi_index* __idx;
+         const table_cache* __cache;
          int32_t            __primary_itr;
          int32_t            __iters[sizeof...(Indices)+(sizeof...(Indices)==0)];
+         bool               __dirty = false;
+         uint64_t           __payer = 0;
       };
 
-      struct item_ptr
+      /**
+       *  Deserialized rows of one (code, scope) table. By default a cache belongs to one multi_index instance
+       *  and its copies. Instances constructed with shared_cache use the cache kept in _table_caches for the
+       *  code and scope, so rows are read and unpacked at most once per action; contract memory is reset before
+       *  each action, which bounds the lifetime of such a cache (and of the database iterators it holds) to the
+       *  action that created it.
+       */
+      struct table_cache
       {
-         item_ptr(std::unique_ptr<item>&& i, uint64_t pk, int32_t pitr)
-         : _item(std::move(i)), _primary_key(pk), _primary_itr(pitr) {}
-
-         std::unique_ptr<item> _item;
-         uint64_t              _primary_key;
-         int32_t               _primary_itr;
+         table_cache( uint64_t c, uint64_t s, table_cache* n, bool sh )
+         :code(c),scope(s),next(n),shared(sh){}
+
+         uint64_t                                  code;
+         uint64_t                                  scope;
+         table_cache*                              next;
+         bool                                      shared;
+         uint64_t                                  next_primary_key = unset_next_primary_key;
+         uint32_t                                  ref_count = 0;
+         bool                                      write_back = false;
+         std::map<uint64_t, std::unique_ptr<item>> items_by_primary_key;
+         std::map<int32_t, item*>                  items_by_primary_itr;
       };
 
-      mutable std::vector<item_ptr> _items_vector;
+      /// zero-initialized so that no global constructor is required
+      static table_cache* _table_caches;
+
+      static table_cache* get_table_cache( uint64_t code, uint64_t scope, bool shared ) {
+         if( !shared )
+            return new table_cache( code, scope, nullptr, false );
+
+         for( auto c = _table_caches; c != nullptr; c = c->next ) {
+            if( c->code == code && c->scope == scope )
+               return c;
+         }
+         _table_caches = new table_cache( code, scope, _table_caches, true );
+         return _table_caches;
+      }
+
+      void release_cache() {
+         if( _cache == nullptr || --_cache->ref_count > 0 )
+            return;
+
+         flush();
+         if( !_cache->shared )
+            delete _cache;
+         _cache = nullptr;
+      }
+
+      table_cache* _cache;
 
       template<uint64_t IndexName, typename Extractor, uint64_t Number, bool IsConst>
       struct index {
@@ -475,7 +516,7 @@ class multi_index
                using namespace _multi_index_detail;
 
                const auto& objitem = static_cast<const item&>(obj);
-               snax_assert( objitem.__idx == _multidx, "object passed to iterator_to is not in multi_index" );
+               snax_assert( objitem.__cache == _multidx->_cache, "object passed to iterator_to is not in multi_index" );
 
                if( objitem.__iters[Number] == -1 ) {
                   secondary_key_type temp_secondary_key;
@@ -551,11 +592,9 @@ class multi_index
       const item& load_object_by_primary_iterator( int32_t itr )const {
          using namespace _multi_index_detail;
 
-         auto itr2 = std::find_if(_items_vector.rbegin(), _items_vector.rend(), [&](const item_ptr& ptr) {
-            return ptr._primary_itr == itr;
-         });
-         if( itr2 != _items_vector.rend() )
-            return *itr2->_item;
+         auto cached = _cache->items_by_primary_itr.find( itr );
+         if( cached != _cache->items_by_primary_itr.end() )
+            return *cached->second;
 
          auto size = db_get_i64( itr, nullptr, 0 );
          snax_assert( size >= 0, "error reading iterator" );
@@ -571,7 +610,7 @@ class multi_index
             free(buffer);
          }
 
-         auto itm = std::make_unique<item>( this, [&]( auto& i ) {
+         auto itm = std::make_unique<item>( _cache, [&]( auto& i ) {
             T& val = static_cast<T&>(i);
             ds >> val;
 
@@ -583,14 +622,30 @@ class multi_index
             });
          });
 
-         const item* ptr = itm.get();
-         auto pk   = itm->primary_key();
-         auto pitr = itm->__primary_itr;
-
-         _items_vector.emplace_back( std::move(itm), pk, pitr );
+         return cache_item( std::move(itm) );
+      } /// load_object_by_primary_iterator
 
+      const item& cache_item( std::unique_ptr<item>&& itm )const {
+         item* ptr = itm.get();
+         _cache->items_by_primary_itr[ptr->__primary_itr] = ptr;
+         _cache->items_by_primary_key[ptr->primary_key()] = std::move(itm);
          return *ptr;
-      } /// load_object_by_primary_iterator
+      }
+
+      void update_primary_row( const item& objitem, uint64_t payer ) {
+         size_t size = pack_size( static_cast<const T&>(objitem) );
+         //using malloc/free here potentially is not exception-safe, although WASM doesn't support exceptions
+         void* buffer = max_stack_buffer_size < size ? malloc(size) : alloca(size);
+
+         datastream<char*> ds( (char*)buffer, size );
+         ds << static_cast<const T&>(objitem);
+
+         db_update_i64( objitem.__primary_itr, payer, buffer, size );
+
+         if ( max_stack_buffer_size < size ) {
+            free( buffer );
+         }
+      }
 
    public:
       /**
@@ -599,6 +654,7 @@ class multi_index
        *
        *  @param code - Account that owns table
        *  @param scope - Scope identifier within the code hierarchy
+       *  @param shared_cache - Whether to share deserialized rows with every other instance of this multi_index type constructed with shared_cache on the same code and scope for the rest of the action
        *
        *  @pre code and scope member properties are initialized
        *  @post each secondary index table initialized
@@ -613,6 +669,7 @@ class multi_index
        *  - Each must be a default constructable class or struct
        *  - Each must have a function call operator that takes a const reference to the table object type and returns either a secondary key type or a reference to a secondary key type
        *  - It is recommended to use the snax::const_mem_fun template, which is a type alias to the boost::multi_index::const_mem_fun.  See the documentation for the Boost const_mem_fun key extractor for more details.
+       *  - A shared cache is only coherent while the table is accessed through this multi_index type: rows changed through other multi_index types or the `db_*_i64` API are not seen by it, and rows it caches may be stale for them.
        *
        *  Example:
        *
@@ -641,9 +698,47 @@ class multi_index
        *  SNAX_ABI( addressbook, (myaction) )
        *  @endcode
        */
-      multi_index( uint64_t code, uint64_t scope )
-      :_code(code),_scope(scope),_next_primary_key(unset_next_primary_key)
-      {}
+      multi_index( uint64_t code, uint64_t scope, bool shared_cache = false )
+      :_code(code),_scope(scope),_cache(get_table_cache(code, scope, shared_cache))
+      {
+         ++_cache->ref_count;
+      }
+
+      /**
+       *  A copy shares the cached rows of other, so objects returned by either can be passed to the other.
+       */
+      multi_index( const multi_index& other )
+      :_code(other._code),_scope(other._scope),_cache(other._cache)
+      {
+         ++_cache->ref_count;
+      }
+
+      multi_index( multi_index&& other )
+      :_code(other._code),_scope(other._scope),_cache(other._cache)
+      {
+         other._cache = nullptr;
+      }
+
+      multi_index& operator=( multi_index&& other ) {
+         if( this != &other ) {
+            release_cache();
+            _code  = other._code;
+            _scope = other._scope;
+            _cache = other._cache;
+            other._cache = nullptr;
+         }
+         return *this;
+      }
+
+      multi_index& operator=( const multi_index& ) = delete;
+
+      /**
+       *  Flushes rows modified in write-back mode once the last multi_index instance using the cache goes away.
+       *  A shared cache keeps its deserialized rows for later instances within the same action.
+       */
+      ~multi_index() {
+         release_cache();
+      }
 
       /**
        *  Returns the `code` member property.
@@ -1380,22 +1475,22 @@ class multi_index
        *  @endcode
        */
       uint64_t available_primary_key()const {
-         if( _next_primary_key == unset_next_primary_key ) {
-            // This is the first time available_primary_key() is called for this multi_index instance.
+         if( _cache->next_primary_key == unset_next_primary_key ) {
+            // This is the first time available_primary_key() is called for this table in the current action.
             if( begin() == end() ) { // empty table
-               _next_primary_key = 0;
+               _cache->next_primary_key = 0;
             } else {
                auto itr = --end(); // last row of table sorted by primary key
                auto pk = itr->primary_key(); // largest primary key currently in table
                if( pk >= no_available_primary_key ) // Reserve the tags
-                  _next_primary_key = no_available_primary_key;
+                  _cache->next_primary_key = no_available_primary_key;
                else
-                  _next_primary_key = pk + 1;
+                  _cache->next_primary_key = pk + 1;
             }
          }
 
-         snax_assert( _next_primary_key < no_available_primary_key, "next primary key in table is at autoincrement limit");
-         return _next_primary_key;
+         snax_assert( _cache->next_primary_key < no_available_primary_key, "next primary key in table is at autoincrement limit");
+         return _cache->next_primary_key;
       }
 
       /**
@@ -1598,7 +1693,7 @@ class multi_index
        */
       const_iterator iterator_to( const T& obj )const {
          const auto& objitem = static_cast<const item&>(obj);
-         snax_assert( objitem.__idx == this, "object passed to iterator_to is not in multi_index" );
+         snax_assert( objitem.__cache == _cache, "object passed to iterator_to is not in multi_index" );
          return {this, &objitem};
       }
       /**
@@ -1659,7 +1754,7 @@ class multi_index
 
          snax_assert( _code == current_receiver(), "cannot create objects in table of another contract" ); // Quick fix for mutating db using multi_index that shouldn't allow mutation. Real fix can come in RC2.
 
-         auto itm = std::make_unique<item>( this, [&]( auto& i ){
+         auto itm = std::make_unique<item>( _cache, [&]( auto& i ){
             T& obj = static_cast<T&>(i);
             constructor( obj );
 
@@ -1679,8 +1774,8 @@ class multi_index
                free(buffer);
             }
 
-            if( pk >= _next_primary_key )
-               _next_primary_key = (pk >= no_available_primary_key) ? no_available_primary_key : (pk + 1);
+            if( pk >= _cache->next_primary_key )
+               _cache->next_primary_key = (pk >= no_available_primary_key) ? no_available_primary_key : (pk + 1);
 
             hana::for_each( _indices, [&]( auto& idx ) {
                typedef typename decltype(+hana::at_c<0>(idx))::type index_type;
@@ -1689,13 +1784,7 @@ class multi_index
             });
          });
 
-         const item* ptr = itm.get();
-         auto pk   = itm->primary_key();
-         auto pitr = itm->__primary_itr;
-
-         _items_vector.emplace_back( std::move(itm), pk, pitr );
-
-         return {this, ptr};
+         return {this, &cache_item( std::move(itm) )};
       }
 
       /**
@@ -1835,7 +1924,7 @@ class multi_index
          using namespace _multi_index_detail;
 
          const auto& objitem = static_cast<const item&>(obj);
-         snax_assert( objitem.__idx == this, "object passed to modify is not in multi_index" );
+         snax_assert( objitem.__cache == _cache, "object passed to modify is not in multi_index" );
          auto& mutableitem = const_cast<item&>(objitem);
          snax_assert( _code == current_receiver(), "cannot modify objects in table of another contract" ); // Quick fix for mutating db using multi_index that shouldn't allow mutation. Real fix can come in RC2.
 
@@ -1852,21 +1941,30 @@ class multi_index
 
          snax_assert( pk == obj.primary_key(), "updater cannot change primary key when modifying an object" );
 
-         size_t size = pack_size( obj );
-         //using malloc/free here potentially is not exception-safe, although WASM doesn't support exceptions
-         void* buffer = max_stack_buffer_size < size ? malloc(size) : alloca(size);
+         if( pk >= _cache->next_primary_key )
+            _cache->next_primary_key = (pk >= no_available_primary_key) ? no_available_primary_key : (pk + 1);
 
-         datastream<char*> ds( (char*)buffer, size );
-         ds << obj;
+         if( _cache->write_back ) {
+            // Secondary index rows are always written through so that index lookups stay consistent;
+            // only a change confined to the primary row can be deferred until flush().
+            bool secondary_changed = false;
+            hana::for_each( _indices, [&]( auto& idx ) {
+               typedef typename decltype(+hana::at_c<0>(idx))::type index_type;
 
-         db_update_i64( objitem.__primary_itr, payer, buffer, size );
+               auto secondary = index_type::extract_secondary_key( obj );
+               if( memcmp( &hana::at_c<index_type::index_number>(secondary_keys), &secondary, sizeof(secondary) ) != 0 )
+                  secondary_changed = true;
+            });
 
-         if ( max_stack_buffer_size < size ) {
-            free( buffer );
+            if( !secondary_changed ) {
+               mutableitem.__dirty = true;
+               mutableitem.__payer = payer;
+               return;
+            }
          }
 
-         if( pk >= _next_primary_key )
-            _next_primary_key = (pk >= no_available_primary_key) ? no_available_primary_key : (pk + 1);
+         update_primary_row( objitem, payer );
+         mutableitem.__dirty = false;
 
          hana::for_each( _indices, [&]( auto& idx ) {
             typedef typename decltype(+hana::at_c<0>(idx))::type index_type;
@@ -1985,11 +2083,9 @@ class multi_index
        *  @endcode
        */
       const_iterator find( uint64_t primary )const {
-         auto itr2 = std::find_if(_items_vector.rbegin(), _items_vector.rend(), [&](const item_ptr& ptr) {
-            return ptr._item->primary_key() == primary;
-         });
-         if( itr2 != _items_vector.rend() )
-            return iterator_to(*(itr2->_item));
+         auto cached = _cache->items_by_primary_key.find( primary );
+         if( cached != _cache->items_by_primary_key.end() )
+            return iterator_to(*cached->second);
 
          auto itr = db_find_i64( _code, _scope, TableName, primary );
          if( itr < 0 ) return end();
@@ -2008,11 +2104,9 @@ class multi_index
        */
 
       const_iterator require_find( uint64_t primary, const char* error_msg = "unable to find key" )const {
-         auto itr2 = std::find_if(_items_vector.rbegin(), _items_vector.rend(), [&](const item_ptr& ptr) {
-               return ptr._item->primary_key() == primary;
-            });
-         if( itr2 != _items_vector.rend() )
-            return iterator_to(*(itr2->_item));
+         auto cached = _cache->items_by_primary_key.find( primary );
+         if( cached != _cache->items_by_primary_key.end() )
+            return iterator_to(*cached->second);
 
          auto itr = db_find_i64( _code, _scope, TableName, primary );
          snax_assert( itr >= 0,  error_msg );
@@ -2151,33 +2245,80 @@ class multi_index
          using namespace _multi_index_detail;
 
          const auto& objitem = static_cast<const item&>(obj);
-         snax_assert( objitem.__idx == this, "object passed to erase is not in multi_index" );
+         snax_assert( objitem.__cache == _cache, "object passed to erase is not in multi_index" );
          snax_assert( _code == current_receiver(), "cannot erase objects in table of another contract" ); // Quick fix for mutating db using multi_index that shouldn't allow mutation. Real fix can come in RC2.
 
          auto pk = objitem.primary_key();
-         auto itr2 = std::find_if(_items_vector.rbegin(), _items_vector.rend(), [&](const item_ptr& ptr) {
-            return ptr._item->primary_key() == pk;
-         });
+         auto cached = _cache->items_by_primary_key.find( pk );
 
-         snax_assert( itr2 != _items_vector.rend(), "attempt to remove object that was not in multi_index" );
+         snax_assert( cached != _cache->items_by_primary_key.end(), "attempt to remove object that was not in multi_index" );
 
-         _items_vector.erase(--(itr2.base()));
+         // Keep the cached object alive until its index iterators have been used.
+         std::unique_ptr<item> removed = std::move( cached->second );
+         _cache->items_by_primary_key.erase( cached );
+         _cache->items_by_primary_itr.erase( removed->__primary_itr );
 
-         db_remove_i64( objitem.__primary_itr );
+         db_remove_i64( removed->__primary_itr );
 
          hana::for_each( _indices, [&]( auto& idx ) {
             typedef typename decltype(+hana::at_c<0>(idx))::type index_type;
 
-            auto i = objitem.__iters[index_type::number()];
+            auto i = removed->__iters[index_type::number()];
             if( i < 0 ) {
               typename index_type::secondary_key_type secondary;
-              i = secondary_index_db_functions<typename index_type::secondary_key_type>::db_idx_find_primary( _code, _scope, index_type::name(), objitem.primary_key(),  secondary );
+              i = secondary_index_db_functions<typename index_type::secondary_key_type>::db_idx_find_primary( _code, _scope, index_type::name(), pk,  secondary );
             }
             if( i >= 0 )
                secondary_index_db_functions<typename index_type::secondary_key_type>::db_idx_remove( i );
          });
       }
 
+      /**
+       *  Enables or disables write-back mode for this table.
+       *  @brief Enables or disables write-back mode for this table.
+       *
+       *  While write-back mode is enabled, `modify` updates the cached object but defers serializing the primary
+       *  row until `flush` is called or the last multi_index instance using the cache is destroyed, so a row
+       *  modified several times within an action is packed and written once. Modifications that change a
+       *  secondary key are still written immediately.
+       *
+       *  @param enabled - whether modifications should be deferred
+       *
+       *  @post Disabling write-back mode flushes any pending modifications.
+       *
+       *  Notes
+       *  The mode applies to every multi_index instance using the same cache: copies of this instance and, for a
+       *  shared cache, instances of the same type on this code and scope for the rest of the action. Rows with
+       *  pending modifications must not be read through other multi_index instances or the `db_*_i64` API
+       *  before they are flushed.
+       */
+      void set_write_back( bool enabled ) {
+         if( !enabled )
+            flush();
+         _cache->write_back = enabled;
+      }
+
+      /**
+       *  Writes all rows with pending write-back modifications to the table.
+       *  @brief Writes all rows with pending write-back modifications to the table.
+       *
+       *  @post Each modified row is serialized once and its payer is charged as if by `modify`.
+       */
+      void flush() {
+         for( auto& entry : _cache->items_by_primary_key ) {
+            auto& i = *entry.second;
+            if( !i.__dirty )
+               continue;
+
+            update_primary_row( i, i.__payer );
+            i.__dirty = false;
+         }
+      }
+
 };
+
+template<uint64_t TableName, typename T, typename... Indices>
+typename multi_index<TableName, T, Indices...>::table_cache* multi_index<TableName, T, Indices...>::_table_caches = nullptr;
+
   /// @}
 }  /// snax
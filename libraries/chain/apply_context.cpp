@@ -29,6 +29,26 @@ static inline void print_debug(account_name receiver, const action_trace& ar) {
    }
 }
 
+apply_context::apply_context(controller& con, transaction_context& trx_ctx, const action& a, uint32_t depth)
+:control(con)
+,db(con.mutable_db())
+,trx_context(trx_ctx)
+,act(a)
+,receiver(act.account)
+,used_authorizations(act.authorization.size(), false)
+,recurse_depth(depth)
+,idx64(*this)
+,idx128(*this)
+,idx256(*this)
+,idx_double(*this)
+,idx_long_double(*this)
+,_notified( scratch_allocator<account_name>( trx_ctx._scratch ) )
+,_inline_actions( scratch_allocator<action>( trx_ctx._scratch ) )
+,_cfa_inline_actions( scratch_allocator<action>( trx_ctx._scratch ) )
+{
+   _pending_console_output.setf( std::ios::scientific, std::ios::floatfield );
+}
+
 void apply_context::exec_one( action_trace& trace )
 {
    auto start = fc::time_point::now();
@@ -104,8 +124,10 @@ void apply_context::finalize_trace( action_trace& trace, const fc::time_point& s
    trace.account_ram_deltas = std::move( _account_ram_deltas );
    _account_ram_deltas.clear();
 
-   trace.console = _pending_console_output.str();
-   reset_console();
+   if( _pending_console_output.tellp() != 0 ) { // also resets a stream left in a failed state
+      trace.console = _pending_console_output.str();
+      reset_console();
+   }
 
    trace.elapsed = fc::time_point::now() - start;
 }
@@ -123,6 +145,7 @@ void apply_context::exec( action_trace& trace )
    if( _cfa_inline_actions.size() > 0 || _inline_actions.size() > 0 ) {
       SNAX_ASSERT( recurse_depth < control.get_global_properties().configuration.max_inline_action_depth,
                   transaction_exception, "max inline action depth per transaction reached" );
+      trace.inline_traces.reserve( trace.inline_traces.size() + _cfa_inline_actions.size() + _inline_actions.size() );
    }
 
    for( const auto& inline_action : _cfa_inline_actions ) {
@@ -454,7 +477,9 @@ vector<account_name> apply_context::get_active_producers() const {
 }
 
 void apply_context::reset_console() {
-   _pending_console_output = std::ostringstream();
+   // keep the stream and its buffer for the next receiver instead of constructing a new one
+   _pending_console_output.str( std::string() );
+   _pending_console_output.clear();
    _pending_console_output.setf( std::ios::scientific, std::ios::floatfield );
 }
 
@@ -15,6 +15,14 @@
 #include <boost/tuple/tuple_io.hpp>
 #include <snax/chain/database_utils.hpp>
 
+#include <boost/multi_index_container.hpp>
+#include <boost/multi_index/sequenced_index.hpp>
+#include <boost/multi_index/ordered_index.hpp>
+#include <boost/multi_index/member.hpp>
+
+#include <algorithm>
+#include <iterator>
+
 
 namespace snax { namespace chain {
 
@@ -24,8 +32,93 @@ namespace snax { namespace chain {
       permission_link_index
    >;
 
+   namespace {
+      struct authority_cache_key {
+         permission_level           permission;
+         fc::microseconds           delay;
+         uint16_t                   depth_limit = 0;
+         flat_set<public_key_type>  provided_keys;
+
+         friend bool operator < ( const authority_cache_key& a, const authority_cache_key& b ) {
+            return std::tie( a.permission, a.delay, a.depth_limit, a.provided_keys )
+                 < std::tie( b.permission, b.delay, b.depth_limit, b.provided_keys );
+         }
+      };
+
+      /**
+       *  A permission_object looked up while satisfying the key, by level, with its authority or nothing
+       *  when it did not exist. The outcome of a check depends on nothing else, so an entry is valid as
+       *  long as these rows read the same. Comparing the contents rather than a version also covers rows
+       *  restored by a chainbase undo (a failed transaction, abort_block, a fork switch), which does not
+       *  go through authorization_manager and may restore a row last updated within the same block.
+       */
+      using authority_cache_dependency = std::pair<permission_level, optional<authority>>;
+
+      struct authority_cache_entry {
+         authority_cache_key                   key;
+         flat_set<public_key_type>             used_keys;
+         vector<authority_cache_dependency>    dependencies;
+      };
+
+      struct by_key;
+
+      typedef boost::multi_index_container<
+         authority_cache_entry,
+         boost::multi_index::indexed_by<
+            boost::multi_index::sequenced<>,
+            boost::multi_index::ordered_unique<
+               boost::multi_index::tag<by_key>,
+               boost::multi_index::member<authority_cache_entry, authority_cache_key, &authority_cache_entry::key>
+            >
+         >
+      > authority_cache_index;
+   }
+
+   struct authorization_manager::authority_cache {
+      authority_cache_index   entries;
+      size_t                  capacity = 0;
+      uint64_t                hits = 0;
+      uint64_t                misses = 0;
+      uint64_t                invalidations = 0;
+      uint64_t                evictions = 0;
+
+      void set_capacity( size_t c ) {
+         capacity = c;
+         while( entries.size() > capacity ) {
+            entries.pop_back();
+            ++evictions;
+         }
+      }
+
+      cache_stats get_stats()const {
+         cache_stats s;
+         s.hits          = hits;
+         s.misses        = misses;
+         s.invalidations = invalidations;
+         s.evictions     = evictions;
+         s.size          = entries.size();
+         s.capacity      = capacity;
+         return s;
+      }
+   };
+
    authorization_manager::authorization_manager(controller& c, database& d)
-   :_control(c),_db(d){}
+   :_control(c),_db(d),_cache(new authority_cache),_required_keys_cache(new authority_cache){}
+
+   authorization_manager::~authorization_manager() = default;
+
+   void authorization_manager::set_cache_capacity( uint32_t capacity ) {
+      _cache->set_capacity( capacity );
+      _required_keys_cache->set_capacity( capacity );
+   }
+
+   authorization_manager::cache_stats authorization_manager::get_cache_stats()const {
+      return _cache->get_stats();
+   }
+
+   authorization_manager::cache_stats authorization_manager::get_required_keys_cache_stats()const {
+      return _required_keys_cache->get_stats();
+   }
 
    void authorization_manager::add_indices() {
       authorization_index_set::add_indices(_db);
@@ -423,6 +516,91 @@ namespace snax { namespace chain {
 
    void noop_checktime() {}
 
+   static bool same_authority( const shared_authority& current, const authority& cached ) {
+      return current.threshold == cached.threshold
+          && std::equal( current.keys.begin(), current.keys.end(), cached.keys.begin(), cached.keys.end() )
+          && std::equal( current.accounts.begin(), current.accounts.end(), cached.accounts.begin(), cached.accounts.end() )
+          && std::equal( current.waits.begin(), current.waits.end(), cached.waits.begin(), cached.waits.end() );
+   }
+
+   static flat_set<public_key_type> unused_keys( const flat_set<public_key_type>& provided_keys,
+                                                 const flat_set<public_key_type>& used_keys ) {
+      flat_set<public_key_type> result;
+      std::set_difference( provided_keys.begin(), provided_keys.end(), used_keys.begin(), used_keys.end(),
+                           std::inserter( result, result.end() ) );
+      return result;
+   }
+
+   /**
+    *  Same result as a fresh authority_checker without provided permissions asked to satisfy level, but
+    *  reuses the outcome of an earlier identical check while none of the permissions it walked changed.
+    *  Adds the keys that satisfied level to used_keys.
+    */
+   bool authorization_manager::satisfied_with_cache( authority_cache&                   cache,
+                                                     const permission_level&            level,
+                                                     fc::microseconds                   provided_delay,
+                                                     const flat_set<public_key_type>&   provided_keys,
+                                                     flat_set<public_key_type>&         used_keys,
+                                                     const std::function<void()>&       checktime )const
+   {
+      authority_cache_key key{ level, provided_delay,
+                               _control.get_global_properties().configuration.max_authority_depth,
+                               provided_keys };
+
+      auto& by_key_idx = cache.entries.get<by_key>();
+      auto itr = by_key_idx.find( key );
+      if( itr != by_key_idx.end() ) {
+         bool valid = true;
+         for( auto d = itr->dependencies.begin(); valid && d != itr->dependencies.end(); ++d ) {
+            const auto* perm = _db.find<permission_object, by_owner>( boost::make_tuple( d->first.actor, d->first.permission ) );
+            valid = perm ? ( d->second && same_authority( perm->auth, *d->second ) ) : !d->second;
+         }
+         if( valid ) {
+            ++cache.hits;
+            cache.entries.relocate( cache.entries.begin(), cache.entries.project<0>( itr ) );
+            used_keys.insert( itr->used_keys.begin(), itr->used_keys.end() );
+            return true;
+         }
+         ++cache.invalidations;
+         by_key_idx.erase( itr );
+      }
+      ++cache.misses;
+
+      vector<authority_cache_dependency> dependencies;
+      auto checker = make_auth_checker( [&]( const permission_level& p ) -> const shared_authority& {
+                                           const auto* perm = find_permission( p );
+                                           dependencies.emplace_back( p, perm ? optional<authority>( perm->auth.to_authority() )
+                                                                              : optional<authority>() );
+                                           return perm ? perm->auth : get_permission( p ).auth; // throws the same error when missing
+                                        },
+                                        key.depth_limit,
+                                        provided_keys,
+                                        {},
+                                        provided_delay,
+                                        checktime
+                                      );
+
+      if( !checker.satisfied( level ) )
+         return false;
+
+      auto keys = checker.used_keys();
+      used_keys.insert( keys.begin(), keys.end() );
+
+      // a permission may be reached through several paths, it reads the same row each time
+      std::sort( dependencies.begin(), dependencies.end(),
+                 []( const auto& a, const auto& b ) { return a.first < b.first; } );
+      dependencies.erase( std::unique( dependencies.begin(), dependencies.end(),
+                                       []( const auto& a, const auto& b ) { return a.first == b.first; } ),
+                          dependencies.end() );
+
+      cache.entries.push_front( authority_cache_entry{ std::move(key), std::move(keys), std::move(dependencies) } );
+      while( cache.entries.size() > cache.capacity ) {
+         cache.entries.pop_back();
+         ++cache.evictions;
+      }
+      return true;
+   }
+
    std::function<void()> authorization_manager::_noop_checktime{&noop_checktime};
 
    void
@@ -432,7 +610,8 @@ namespace snax { namespace chain {
                                                fc::microseconds                     provided_delay,
                                                const std::function<void()>&         _checktime,
                                                bool                                 allow_unused_keys,
-                                               const flat_set<permission_level>&    satisfied_authorizations
+                                               const flat_set<permission_level>&    satisfied_authorizations,
+                                               bool                                 cacheable
                                              )const
    {
       const auto& checktime = ( static_cast<bool>(_checktime) ? _checktime : _noop_checktime );
@@ -449,6 +628,10 @@ namespace snax { namespace chain {
                                         checktime
                                       );
 
+      // results for exactly these keys can be shared with other transactions only when no permissions are provided
+      const bool use_cache = cacheable && _cache->capacity > 0 && provided_permissions.empty();
+      flat_set<public_key_type> used_keys;
+
       map<permission_level, fc::microseconds> permissions_to_satisfy;
 
       for( const auto& act : actions ) {
@@ -507,7 +690,9 @@ namespace snax { namespace chain {
       // ascending order of the actor name with ties broken by ascending order of the permission name.
       for( const auto& p : permissions_to_satisfy ) {
          checktime(); // TODO: this should eventually move into authority_checker instead
-         SNAX_ASSERT( checker.satisfied( p.first, p.second ), unsatisfied_authorization,
+         bool satisfied = use_cache ? satisfied_with_cache( *_cache, p.first, p.second, provided_keys, used_keys, checktime )
+                                    : checker.satisfied( p.first, p.second );
+         SNAX_ASSERT( satisfied, unsatisfied_authorization,
                      "transaction declares authority '${auth}', "
                      "but does not have signatures for it under a provided delay of ${provided_delay} ms, "
                      "provided permissions ${provided_permissions}, provided keys ${provided_keys}, "
@@ -522,9 +707,15 @@ namespace snax { namespace chain {
       }
 
       if( !allow_unused_keys ) {
-         SNAX_ASSERT( checker.all_keys_used(), tx_irrelevant_sig,
-                     "transaction bears irrelevant signatures from these keys: ${keys}",
-                     ("keys", checker.unused_keys()) );
+         if( use_cache ) {
+            SNAX_ASSERT( used_keys.size() == provided_keys.size(), tx_irrelevant_sig,
+                        "transaction bears irrelevant signatures from these keys: ${keys}",
+                        ("keys", unused_keys( provided_keys, used_keys )) );
+         } else {
+            SNAX_ASSERT( checker.all_keys_used(), tx_irrelevant_sig,
+                        "transaction bears irrelevant signatures from these keys: ${keys}",
+                        ("keys", checker.unused_keys()) );
+         }
       }
    }
 
@@ -535,22 +726,30 @@ namespace snax { namespace chain {
                                                const flat_set<permission_level>&    provided_permissions,
                                                fc::microseconds                     provided_delay,
                                                const std::function<void()>&         _checktime,
-                                               bool                                 allow_unused_keys
+                                               bool                                 allow_unused_keys,
+                                               bool                                 cacheable
                                              )const
    {
       const auto& checktime = ( static_cast<bool>(_checktime) ? _checktime : _noop_checktime );
 
       auto delay_max_limit = fc::seconds( _control.get_global_properties().configuration.max_transaction_delay );
 
+      auto effective_provided_delay = ( provided_delay >= delay_max_limit ) ? fc::microseconds::maximum() : provided_delay;
+
       auto checker = make_auth_checker( [&](const permission_level& p){ return get_permission(p).auth; },
                                         _control.get_global_properties().configuration.max_authority_depth,
                                         provided_keys,
                                         provided_permissions,
-                                        ( provided_delay >= delay_max_limit ) ? fc::microseconds::maximum() : provided_delay,
+                                        effective_provided_delay,
                                         checktime
                                       );
 
-      SNAX_ASSERT( checker.satisfied({account, permission}), unsatisfied_authorization,
+      const bool use_cache = cacheable && _cache->capacity > 0 && provided_permissions.empty();
+      flat_set<public_key_type> used_keys;
+
+      bool satisfied = use_cache ? satisfied_with_cache( *_cache, {account, permission}, effective_provided_delay, provided_keys, used_keys, checktime )
+                                 : checker.satisfied( {account, permission} );
+      SNAX_ASSERT( satisfied, unsatisfied_authorization,
                   "permission '${auth}' was not satisfied under a provided delay of ${provided_delay} ms, "
                   "provided permissions ${provided_permissions}, provided keys ${provided_keys}, "
                   "and a delay max limit of ${delay_max_limit_ms} ms",
@@ -562,9 +761,15 @@ namespace snax { namespace chain {
                 );
 
       if( !allow_unused_keys ) {
-         SNAX_ASSERT( checker.all_keys_used(), tx_irrelevant_sig,
-                     "irrelevant keys provided: ${keys}",
-                     ("keys", checker.unused_keys()) );
+         if( use_cache ) {
+            SNAX_ASSERT( used_keys.size() == provided_keys.size(), tx_irrelevant_sig,
+                        "irrelevant keys provided: ${keys}",
+                        ("keys", unused_keys( provided_keys, used_keys )) );
+         } else {
+            SNAX_ASSERT( checker.all_keys_used(), tx_irrelevant_sig,
+                        "irrelevant keys provided: ${keys}",
+                        ("keys", checker.unused_keys()) );
+         }
       }
    }
 
@@ -573,6 +778,24 @@ namespace snax { namespace chain {
                                                                        fc::microseconds provided_delay
                                                                      )const
    {
+      if( _required_keys_cache->capacity > 0 ) {
+         // the keys used for each declared authority do not depend on the other ones, memoize them per authority;
+         // candidate keys come from API callers, so they get a cache of their own rather than evicting consensus results
+         flat_set<public_key_type> used_keys;
+         flat_set<permission_level> checked;
+         for( const auto& act : trx.actions ) {
+            for( const auto& declared_auth : act.authorization ) {
+               if( !checked.insert( declared_auth ).second )
+                  continue;
+               SNAX_ASSERT( satisfied_with_cache( *_required_keys_cache, declared_auth, provided_delay, candidate_keys, used_keys, _noop_checktime ),
+                           unsatisfied_authorization,
+                           "transaction declares authority '${auth}', but does not have signatures for it.",
+                           ("auth", declared_auth) );
+            }
+         }
+         return used_keys;
+      }
+
       auto checker = make_auth_checker( [&](const permission_level& p){ return get_permission(p).auth; },
                                         _control.get_global_properties().configuration.max_authority_depth,
                                         candidate_keys,
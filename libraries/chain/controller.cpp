@@ -1,4 +1,5 @@
 #include <snax/chain/controller.hpp>
+#include <snax/chain/controller_metrics.hpp>
 #include <snax/chain/transaction_context.hpp>
 
 #include <snax/chain/block_log.hpp>
@@ -16,6 +17,7 @@
 
 #include <snax/chain/authorization_manager.hpp>
 #include <snax/chain/resource_limits.hpp>
+#include <snax/chain/signature_recovery_cache.hpp>
 #include <snax/chain/chain_snapshot.hpp>
 
 #include <chainbase/chainbase.hpp>
@@ -106,6 +108,10 @@ struct pending_state {
 
    vector<action_receipt>             _actions;
 
+   /// roots over the leading receipts in _actions and the block's transactions, see update_pending_merkles
+   merkle_accumulator                 _action_merkle;
+   merkle_accumulator                 _trx_merkle;
+
    controller::block_status           _block_status = controller::block_status::incomplete;
 
    optional<block_id_type>            _producer_block_id;
@@ -136,6 +142,7 @@ struct controller_impl {
    bool                           trusted_producer_light_validation = false;
    uint32_t                       snapshot_head_block = 0;
    optional<boost::asio::thread_pool>  thread_pool;
+   controller_metrics             metrics;
 
    typedef pair<scope_name,action_name>                   handler_key;
    map< account_name, map<handler_key, apply_handler> >   apply_handlers;
@@ -219,6 +226,23 @@ struct controller_impl {
                                  on_irreversible(b);
                                  });
 
+   signature_recovery_cache::instance().set_capacity( cfg.sig_cache_size );
+   authorization.set_cache_capacity( cfg.auth_cache_size );
+
+   }
+
+   /// metrics stage that times handlers of signal s
+   template<typename Signal>
+   controller_metrics::stage_type emit_stage( const Signal& s )const {
+      const void* p = &s;
+      if( p == &self.pre_accepted_block )        return controller_metrics::emit_pre_accepted_block;
+      if( p == &self.accepted_block_header )     return controller_metrics::emit_accepted_block_header;
+      if( p == &self.accepted_block )            return controller_metrics::emit_accepted_block;
+      if( p == &self.irreversible_block )        return controller_metrics::emit_irreversible_block;
+      if( p == &self.accepted_transaction )      return controller_metrics::emit_accepted_transaction;
+      if( p == &self.applied_transaction )       return controller_metrics::emit_applied_transaction;
+      if( p == &self.accepted_confirmation )     return controller_metrics::emit_accepted_confirmation;
+      return controller_metrics::emit_other;
    }
 
    /**
@@ -232,6 +256,7 @@ struct controller_impl {
     */
    template<typename Signal, typename Arg>
    void emit( const Signal& s, Arg&& a ) {
+      controller_metrics::scoped_timer timer( metrics, emit_stage(s) );
       try {
         s(std::forward<Arg>(a));
       } catch (boost::interprocess::bad_alloc& e) {
@@ -695,6 +720,7 @@ struct controller_impl {
     * @post regardless of the success of commit block there is no active pending block
     */
    void commit_block( bool add_to_fork_db ) {
+      controller_metrics::scoped_timer timer( metrics, controller_metrics::commit_block );
       auto reset_pending_on_exit = fc::make_scoped_exit([this]{
          pending.reset();
       });
@@ -741,6 +767,11 @@ struct controller_impl {
          pending->_pending_block_state->block->transactions.resize(orig_block_transactions_size);
          pending->_pending_block_state->trxs.resize(orig_state_transactions_size);
          pending->_actions.resize(orig_state_actions_size);
+         // receipts already folded into the merkles are not expected to be removed, start over if they are
+         if( pending->_trx_merkle.size() > orig_block_transactions_size )
+            pending->_trx_merkle.reset();
+         if( pending->_action_merkle.size() > orig_state_actions_size )
+            pending->_action_merkle.reset();
       };
 
       return fc::make_scoped_exit( std::move(callback) );
@@ -782,6 +813,7 @@ struct controller_impl {
 
          trx_context.squash();
          restore.cancel();
+         update_pending_merkles();
          return trace;
       } catch( const fc::exception& e ) {
          cpu_time_to_bill_us = trx_context.update_billed_cpu_time( fc::time_point::now() );
@@ -833,6 +865,7 @@ struct controller_impl {
 
    transaction_trace_ptr push_scheduled_transaction( const generated_transaction_object& gto, fc::time_point deadline, uint32_t billed_cpu_time_us, bool explicit_billed_cpu_time = false )
    { try {
+      controller_metrics::scoped_timer timer( metrics, controller_metrics::push_scheduled_transaction );
       maybe_session undo_session;
       if ( !self.skip_db_sessions() )
          undo_session = maybe_session(db);
@@ -870,6 +903,7 @@ struct controller_impl {
          emit( self.accepted_transaction, trx );
          emit( self.applied_transaction, trace );
          undo_session.squash();
+         metrics.increment( controller_metrics::trx_expired );
          return trace;
       }
 
@@ -913,7 +947,9 @@ struct controller_impl {
          undo_session.squash();
 
          restore.cancel();
+         update_pending_merkles();
 
+         metrics.increment( controller_metrics::trx_applied );
          return trace;
       } catch( const fc::exception& e ) {
          cpu_time_to_bill_us = trx_context.update_billed_cpu_time( fc::time_point::now() );
@@ -937,6 +973,7 @@ struct controller_impl {
             emit( self.accepted_transaction, trx );
             emit( self.applied_transaction, trace );
             undo_session.squash();
+            metrics.increment( controller_metrics::trx_failed );
             return trace;
          }
          trace->elapsed = fc::time_point::now() - trx_context.start;
@@ -975,9 +1012,11 @@ struct controller_impl {
          emit( self.applied_transaction, trace );
 
          undo_session.squash();
+         metrics.increment( controller_metrics::trx_failed );
       } else {
          emit( self.accepted_transaction, trx );
          emit( self.applied_transaction, trace );
+         metrics.increment( controller_metrics::trx_subjective_failed );
       }
 
       return trace;
@@ -1011,6 +1050,7 @@ struct controller_impl {
                                            bool explicit_billed_cpu_time = false )
    {
       SNAX_ASSERT(deadline != fc::time_point(), transaction_exception, "deadline cannot be uninitialized");
+      controller_metrics::scoped_timer timer( metrics, controller_metrics::push_transaction );
 
       transaction_trace_ptr trace;
       try {
@@ -1028,8 +1068,8 @@ struct controller_impl {
                trx_context.enforce_whiteblacklist = false;
             } else {
                bool skip_recording = replay_head_time && (time_point(trx->trx.expiration) <= *replay_head_time);
-               trx_context.init_for_input_trx( trx->packed_trx.get_unprunable_size(),
-                                               trx->packed_trx.get_prunable_size(),
+               trx_context.init_for_input_trx( trx->packed_trx->get_unprunable_size(),
+                                               trx->packed_trx->get_prunable_size(),
                                                trx->trx.signatures.size(),
                                                skip_recording);
             }
@@ -1055,7 +1095,7 @@ struct controller_impl {
                transaction_receipt::status_enum s = (trx_context.delay == fc::seconds(0))
                                                     ? transaction_receipt::executed
                                                     : transaction_receipt::delayed;
-               trace->receipt = push_receipt(trx->packed_trx, s, trx_context.billed_cpu_time_us, trace->net_usage);
+               trace->receipt = push_receipt(*trx->packed_trx, s, trx_context.billed_cpu_time_us, trace->net_usage);
                pending->_pending_block_state->trxs.emplace_back(trx);
             } else {
                transaction_receipt_header r;
@@ -1082,10 +1122,12 @@ struct controller_impl {
             } else {
                restore.cancel();
                trx_context.squash();
+               update_pending_merkles();
             }
 
             if (!trx->implicit) {
                unapplied_transactions.erase( trx->signed_id );
+               metrics.increment( controller_metrics::trx_applied );
             }
             return trace;
          } catch (const fc::exception& e) {
@@ -1095,6 +1137,9 @@ struct controller_impl {
 
          if (!failure_is_subjective(*trace->except)) {
             unapplied_transactions.erase( trx->signed_id );
+            metrics.increment( controller_metrics::trx_failed );
+         } else {
+            metrics.increment( controller_metrics::trx_subjective_failed );
          }
 
          emit( self.accepted_transaction, trx );
@@ -1109,6 +1154,7 @@ struct controller_impl {
                      const optional<block_id_type>& producer_block_id )
    {
       SNAX_ASSERT( !pending, block_validate_exception, "pending block already exists" );
+      controller_metrics::scoped_timer timer( metrics, controller_metrics::start_block );
 
       auto guard_pending = fc::make_scoped_exit([this](){
          pending.reset();
@@ -1425,29 +1471,39 @@ struct controller_impl {
       return false;
    }
 
-   void set_action_merkle() {
-      vector<digest_type> action_digests;
-      action_digests.reserve( pending->_actions.size() );
-      for( const auto& a : pending->_actions )
-         action_digests.emplace_back( a.digest() );
+   /**
+    *  Folds receipts appended since the last call into the pending merkle accumulators. Called once a
+    *  transaction's receipts can no longer be rolled back, so finalize_block only has to hash what is left.
+    */
+   void update_pending_merkles() {
+      const auto& actions = pending->_actions;
+      auto& action_merkle = pending->_action_merkle;
+      for( auto i = action_merkle.size(); i < actions.size(); ++i )
+         action_merkle.append( actions[i].digest() );
 
-      pending->_pending_block_state->header.action_mroot = merkle( move(action_digests) );
+      const auto& trxs = pending->_pending_block_state->block->transactions;
+      auto& trx_merkle = pending->_trx_merkle;
+      for( auto i = trx_merkle.size(); i < trxs.size(); ++i )
+         trx_merkle.append( trxs[i].digest() );
    }
 
-   void set_trx_merkle() {
-      vector<digest_type> trx_digests;
-      const auto& trxs = pending->_pending_block_state->block->transactions;
-      trx_digests.reserve( trxs.size() );
-      for( const auto& a : trxs )
-         trx_digests.emplace_back( a.digest() );
+   void set_action_merkle() {
+      controller_metrics::scoped_timer timer( metrics, controller_metrics::set_action_merkle );
+      update_pending_merkles();
+      pending->_pending_block_state->header.action_mroot = pending->_action_merkle.root();
+   }
 
-      pending->_pending_block_state->header.transaction_mroot = merkle( move(trx_digests) );
+   void set_trx_merkle() {
+      controller_metrics::scoped_timer timer( metrics, controller_metrics::set_trx_merkle );
+      update_pending_merkles();
+      pending->_pending_block_state->header.transaction_mroot = pending->_trx_merkle.root();
    }
 
 
    void finalize_block()
    {
       SNAX_ASSERT(pending, block_validate_exception, "it is not valid to finalize when there is no pending block");
+      controller_metrics::scoped_timer timer( metrics, controller_metrics::finalize_block );
       try {
 
 
@@ -1474,7 +1530,10 @@ struct controller_impl {
          { CPU_TARGET, chain_config.max_block_cpu_usage, config::block_cpu_usage_average_window_ms / config::block_interval_ms, max_virtual_mult, {99, 100}, {1000, 999}},
          {SNAX_PERCENT(chain_config.max_block_net_usage, chain_config.target_block_net_usage_pct), chain_config.max_block_net_usage, config::block_size_average_window_ms / config::block_interval_ms, max_virtual_mult, {99, 100}, {1000, 999}}
       );
-      resource_limits.process_block_usage(pending->_pending_block_state->block_num);
+      {
+         controller_metrics::scoped_timer timer( metrics, controller_metrics::process_block_usage );
+         resource_limits.process_block_usage(pending->_pending_block_state->block_num);
+      }
 
       set_action_merkle();
       set_trx_merkle();
@@ -1539,6 +1598,9 @@ struct controller_impl {
       while( (!dedupe_index.empty()) && ( now > fc::time_point(dedupe_index.begin()->expiration) ) ) {
          transaction_idx.remove(*dedupe_index.begin());
       }
+
+      // keys recovered for transactions that can no longer be included are not needed anymore
+      signature_recovery_cache::instance().remove_expired( time_point_sec( now ) );
    }
 
    bool sender_avoids_whitelist_blacklist_enforcement( account_name sender )const {
@@ -2084,6 +2146,15 @@ chain_id_type controller::get_chain_id()const {
    return my->chain_id;
 }
 
+boost::asio::thread_pool& controller::get_thread_pool() {
+   SNAX_ASSERT( my->thread_pool, misc_exception, "controller thread pool is not started" );
+   return *my->thread_pool;
+}
+
+const controller_metrics& controller::get_metrics()const {
+   return my->metrics;
+}
+
 db_read_mode controller::get_read_mode()const {
    return my->read_mode;
 }
@@ -0,0 +1,107 @@
+/**
+ *  @file
+ *  @copyright defined in snax/LICENSE.txt
+ */
+#include <snax/chain/controller_metrics.hpp>
+
+#include <sstream>
+
+namespace snax { namespace chain {
+
+   constexpr size_t controller_metrics::bucket_count;
+
+   const char* controller_metrics::stage_name( stage_type s ) {
+      switch( s ) {
+         case start_block:                return "start_block";
+         case push_transaction:           return "push_transaction";
+         case push_scheduled_transaction: return "push_scheduled_transaction";
+         case finalize_block:             return "finalize_block";
+         case process_block_usage:        return "process_block_usage";
+         case set_action_merkle:          return "set_action_merkle";
+         case set_trx_merkle:             return "set_trx_merkle";
+         case commit_block:               return "commit_block";
+         case emit_pre_accepted_block:    return "emit_pre_accepted_block";
+         case emit_accepted_block_header: return "emit_accepted_block_header";
+         case emit_accepted_block:        return "emit_accepted_block";
+         case emit_irreversible_block:    return "emit_irreversible_block";
+         case emit_accepted_transaction:  return "emit_accepted_transaction";
+         case emit_applied_transaction:   return "emit_applied_transaction";
+         case emit_accepted_confirmation: return "emit_accepted_confirmation";
+         case emit_other:                 return "emit_other";
+         default:                         return "unknown";
+      }
+   }
+
+   void controller_metrics::record( stage_type s, int64_t elapsed_us ) {
+      uint64_t us = elapsed_us > 0 ? static_cast<uint64_t>(elapsed_us) : 0;
+      auto& st = _stages[s];
+
+      size_t bucket = 0;
+      while( bucket + 1 < bucket_count && us >= (uint64_t(1) << bucket) )
+         ++bucket;
+
+      st.count.fetch_add( 1, std::memory_order_relaxed );
+      st.sum_us.fetch_add( us, std::memory_order_relaxed );
+      st.buckets[bucket].fetch_add( 1, std::memory_order_relaxed );
+
+      auto max = st.max_us.load( std::memory_order_relaxed );
+      while( us > max && !st.max_us.compare_exchange_weak( max, us, std::memory_order_relaxed ) ) {}
+   }
+
+   controller_metrics::snapshot controller_metrics::get_snapshot()const {
+      snapshot result;
+      result.stages.reserve( stage_count );
+      for( size_t i = 0; i < stage_count; ++i ) {
+         const auto& st = _stages[i];
+         histogram h;
+         h.stage  = stage_name( static_cast<stage_type>(i) );
+         h.count  = st.count.load( std::memory_order_relaxed );
+         h.sum_us = st.sum_us.load( std::memory_order_relaxed );
+         h.max_us = st.max_us.load( std::memory_order_relaxed );
+         h.buckets.reserve( bucket_count );
+         for( const auto& b : st.buckets )
+            h.buckets.push_back( b.load( std::memory_order_relaxed ) );
+         result.stages.emplace_back( std::move(h) );
+      }
+      result.trx_applied           = _counters[trx_applied].load( std::memory_order_relaxed );
+      result.trx_failed            = _counters[trx_failed].load( std::memory_order_relaxed );
+      result.trx_expired           = _counters[trx_expired].load( std::memory_order_relaxed );
+      result.trx_subjective_failed = _counters[trx_subjective_failed].load( std::memory_order_relaxed );
+      return result;
+   }
+
+   string controller_metrics::to_prometheus()const {
+      const auto snap = get_snapshot();
+      std::ostringstream out;
+
+      out << "# HELP snax_controller_stage_duration_us Time spent in controller stages in microseconds\n"
+          << "# TYPE snax_controller_stage_duration_us histogram\n";
+      for( const auto& h : snap.stages ) {
+         uint64_t cumulative = 0;
+         for( size_t i = 0; i + 1 < h.buckets.size(); ++i ) {
+            // samples are whole microseconds, so "below 2^i" is "at most 2^i - 1"
+            cumulative += h.buckets[i];
+            out << "snax_controller_stage_duration_us_bucket{stage=\"" << h.stage << "\",le=\"" << ((uint64_t(1) << i) - 1) << "\"} "
+                << cumulative << "\n";
+         }
+         out << "snax_controller_stage_duration_us_bucket{stage=\"" << h.stage << "\",le=\"+Inf\"} " << h.count << "\n"
+             << "snax_controller_stage_duration_us_sum{stage=\"" << h.stage << "\"} " << h.sum_us << "\n"
+             << "snax_controller_stage_duration_us_count{stage=\"" << h.stage << "\"} " << h.count << "\n";
+      }
+
+      out << "# HELP snax_controller_stage_duration_us_max Longest time spent in a controller stage in microseconds\n"
+          << "# TYPE snax_controller_stage_duration_us_max gauge\n";
+      for( const auto& h : snap.stages )
+         out << "snax_controller_stage_duration_us_max{stage=\"" << h.stage << "\"} " << h.max_us << "\n";
+
+      out << "# HELP snax_controller_transactions_total Transactions processed by the controller by outcome\n"
+          << "# TYPE snax_controller_transactions_total counter\n"
+          << "snax_controller_transactions_total{result=\"applied\"} " << snap.trx_applied << "\n"
+          << "snax_controller_transactions_total{result=\"failed\"} " << snap.trx_failed << "\n"
+          << "snax_controller_transactions_total{result=\"expired\"} " << snap.trx_expired << "\n"
+          << "snax_controller_transactions_total{result=\"subjective_failed\"} " << snap.trx_subjective_failed << "\n";
+
+      return out.str();
+   }
+
+} } /// snax::chain
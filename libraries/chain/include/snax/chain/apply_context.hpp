@@ -6,6 +6,7 @@
 #include <snax/chain/controller.hpp>
 #include <snax/chain/transaction.hpp>
 #include <snax/chain/contract_table_objects.hpp>
+#include <snax/chain/scratch_arena.hpp>
 #include <fc/utility.hpp>
 #include <sstream>
 #include <algorithm>
@@ -23,10 +24,9 @@ class apply_context {
       template<typename T>
       class iterator_cache {
          public:
-            iterator_cache(){
-               _end_iterator_to_table.reserve(8);
-               _iterator_to_object.reserve(32);
-            }
+            // an apply_context holds one cache per index type and most actions touch at most one of them,
+            // so storage is only reserved once the cache is used
+            iterator_cache(){}
 
             /// Returns end iterator of the table.
             int cache_table( const table_id_object& tobj ) {
@@ -34,6 +34,8 @@ class apply_context {
                if( itr != _table_cache.end() )
                   return itr->second.second;
 
+               if( _end_iterator_to_table.empty() )
+                  _end_iterator_to_table.reserve(8);
                auto ei = index_to_end_iterator(_end_iterator_to_table.size());
                _end_iterator_to_table.push_back( &tobj );
                _table_cache.emplace( tobj.id, make_pair(&tobj, ei) );
@@ -83,6 +85,8 @@ class apply_context {
                if( itr != _object_to_iterator.end() )
                     return itr->second;
 
+               if( _iterator_to_object.empty() )
+                  _iterator_to_object.reserve(32);
                _iterator_to_object.push_back( &obj );
                _object_to_iterator[&obj] = _iterator_to_object.size() - 1;
 
@@ -451,22 +455,7 @@ class apply_context {
 
    /// Constructor
    public:
-      apply_context(controller& con, transaction_context& trx_ctx, const action& a, uint32_t depth=0)
-      :control(con)
-      ,db(con.mutable_db())
-      ,trx_context(trx_ctx)
-      ,act(a)
-      ,receiver(act.account)
-      ,used_authorizations(act.authorization.size(), false)
-      ,recurse_depth(depth)
-      ,idx64(*this)
-      ,idx128(*this)
-      ,idx256(*this)
-      ,idx_double(*this)
-      ,idx_long_double(*this)
-      {
-         reset_console();
-      }
+      apply_context(controller& con, transaction_context& trx_ctx, const action& a, uint32_t depth=0);
 
 
    /// Execution methods:
@@ -600,9 +589,9 @@ class apply_context {
    private:
 
       iterator_cache<key_value_object>    keyval_cache;
-      vector<account_name>                _notified; ///< keeps track of new accounts to be notifed of current message
-      vector<action>                      _inline_actions; ///< queued inline messages
-      vector<action>                      _cfa_inline_actions; ///< queued inline messages
+      scratch_vector<account_name>        _notified; ///< keeps track of new accounts to be notifed of current message
+      scratch_vector<action>              _inline_actions; ///< queued inline messages
+      scratch_vector<action>              _cfa_inline_actions; ///< queued inline messages
       std::ostringstream                  _pending_console_output;
       flat_set<account_delta>             _account_ram_deltas; ///< flat_set of account_delta so json is an array of objects
 
@@ -10,6 +10,7 @@
 
 #include <utility>
 #include <functional>
+#include <memory>
 
 namespace snax { namespace chain {
 
@@ -24,7 +25,17 @@ namespace snax { namespace chain {
       public:
          using permission_id_type = permission_object::id_type;
 
+         struct cache_stats {
+            uint64_t hits          = 0;
+            uint64_t misses        = 0;
+            uint64_t invalidations = 0; ///< entries dropped because a permission they depend on changed
+            uint64_t evictions     = 0;
+            uint64_t size          = 0;
+            uint64_t capacity      = 0;
+         };
+
          explicit authorization_manager(controller& c, chainbase::database& d);
+         ~authorization_manager();
 
          void add_indices();
          void initialize_database();
@@ -77,6 +88,7 @@ namespace snax { namespace chain {
           *  @param provided_delay - the delay satisfied by the transaction
           *  @param checktime - the function that can be called to track CPU usage and time during the process of checking authorization
           *  @param allow_unused_keys - true if method should not assert on unused keys
+          *  @param cacheable - false to neither use nor fill the authority cache, e.g. for checks requested by contracts
           */
          void
          check_authorization( const vector<action>&                actions,
@@ -85,7 +97,8 @@ namespace snax { namespace chain {
                               fc::microseconds                     provided_delay = fc::microseconds(0),
                               const std::function<void()>&         checktime = std::function<void()>(),
                               bool                                 allow_unused_keys = false,
-                              const flat_set<permission_level>&    satisfied_authorizations = flat_set<permission_level>()
+                              const flat_set<permission_level>&    satisfied_authorizations = flat_set<permission_level>(),
+                              bool                                 cacheable = true
                             )const;
 
 
@@ -99,6 +112,7 @@ namespace snax { namespace chain {
           *  @param provided_delay - the delay considered to be satisfied for the authorization check
           *  @param checktime - the function that can be called to track CPU usage and time during the process of checking authorization
           *  @param allow_unused_keys - true if method does not require all keys to be used
+          *  @param cacheable - false to neither use nor fill the authority cache, e.g. for checks requested by contracts
           */
          void
          check_authorization( account_name                         account,
@@ -107,7 +121,8 @@ namespace snax { namespace chain {
                               const flat_set<permission_level>&    provided_permissions = flat_set<permission_level>(),
                               fc::microseconds                     provided_delay = fc::microseconds(0),
                               const std::function<void()>&         checktime = std::function<void()>(),
-                              bool                                 allow_unused_keys = false
+                              bool                                 allow_unused_keys = false,
+                              bool                                 cacheable = true
                             )const;
 
          flat_set<public_key_type> get_required_keys( const transaction& trx,
@@ -116,11 +131,31 @@ namespace snax { namespace chain {
                                                     )const;
 
 
+         /**
+          *  Set the number of satisfied (permission, delay, provided keys) results kept to skip walking
+          *  the permission tree on repeated checks, separately for check_authorization and for
+          *  get_required_keys. 0 disables both caches.
+          */
+         void        set_cache_capacity( uint32_t capacity );
+         cache_stats get_cache_stats()const;
+         cache_stats get_required_keys_cache_stats()const;
+
          static std::function<void()> _noop_checktime;
 
       private:
-         const controller&    _control;
-         chainbase::database& _db;
+         struct authority_cache;
+
+         const controller&                  _control;
+         chainbase::database&               _db;
+         std::unique_ptr<authority_cache>   _cache;
+         std::unique_ptr<authority_cache>   _required_keys_cache;
+
+         bool satisfied_with_cache( authority_cache&                   cache,
+                                    const permission_level&            level,
+                                    fc::microseconds                   provided_delay,
+                                    const flat_set<public_key_type>&   provided_keys,
+                                    flat_set<public_key_type>&         used_keys,
+                                    const std::function<void()>&       checktime )const;
 
          void             check_updateauth_authorization( const updateauth& update, const vector<permission_level>& auths )const;
          void             check_deleteauth_authorization( const deleteauth& del, const vector<permission_level>& auths )const;
@@ -135,3 +170,5 @@ namespace snax { namespace chain {
    };
 
 } } /// namespace snax::chain
+
+FC_REFLECT( snax::chain::authorization_manager::cache_stats, (hits)(misses)(invalidations)(evictions)(size)(capacity) )
@@ -86,6 +86,8 @@ const static uint32_t   default_max_inline_action_size         = 4 * 1024;   //
 const static uint16_t   default_max_inline_action_depth        = 4;
 const static uint16_t   default_max_auth_depth                 = 6;
 const static uint16_t   default_controller_thread_pool_size    = 2;
+const static uint32_t   default_sig_cache_size                 = 16 * 1024; ///< recovered signature keys cached across all threads
+const static uint32_t   default_auth_cache_size                = 16 * 1024; ///< satisfied authority checks cached by authorization_manager
 
 const static uint32_t   min_net_usage_delta_between_base_and_max_for_trx  = 10*1024;
 // Should be large enough to allow recovery from badly set blockchain parameters without a hard fork
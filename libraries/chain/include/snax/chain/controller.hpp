@@ -12,10 +12,15 @@ namespace chainbase {
    class database;
 }
 
+namespace boost { namespace asio {
+   class thread_pool;
+}}
+
 
 namespace snax { namespace chain {
 
    class authorization_manager;
+   class controller_metrics;
 
    namespace resource_limits {
       class resource_limits_manager;
@@ -65,6 +70,8 @@ namespace snax { namespace chain {
             uint64_t                 reversible_cache_size  =  chain::config::default_reversible_cache_size;
             uint64_t                 reversible_guard_size  =  chain::config::default_reversible_guard_size;
             uint16_t                 thread_pool_size       =  chain::config::default_controller_thread_pool_size;
+            uint32_t                 sig_cache_size         =  chain::config::default_sig_cache_size;
+            uint32_t                 auth_cache_size        =  chain::config::default_auth_cache_size;
             bool                     read_only              =  false;
             bool                     force_all_checks       =  false;
             bool                     disable_replay_opts    =  false;
@@ -225,6 +232,15 @@ namespace snax { namespace chain {
 
          chain_id_type get_chain_id()const;
 
+         /**
+          *  Worker threads shared by the controller and plugins for context-free work such as
+          *  signature recovery and block header validation. Available after startup().
+          */
+         boost::asio::thread_pool& get_thread_pool();
+
+         /// stage latency histograms and transaction outcome counters since startup
+         const controller_metrics& get_metrics()const;
+
          db_read_mode get_read_mode()const;
          validation_mode get_validation_mode()const;
 
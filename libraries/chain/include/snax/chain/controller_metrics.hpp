@@ -0,0 +1,115 @@
+/**
+ *  @file
+ *  @copyright defined in snax/LICENSE.txt
+ */
+#pragma once
+#include <snax/chain/types.hpp>
+
+#include <array>
+#include <atomic>
+#include <chrono>
+
+namespace snax { namespace chain {
+
+   /**
+    *  Latency histograms of the controller's block and transaction stages, and transaction outcome counters.
+    *
+    *  Recording a sample is a handful of relaxed atomic updates, so the instrumentation stays enabled in
+    *  production. Readers (the chain api) may take a snapshot from any thread. Stages nest: push_transaction
+    *  includes the emit_* time of its signals, finalize_block includes process_block_usage and the merkle stages.
+    */
+   class controller_metrics {
+      public:
+         enum stage_type {
+            start_block,
+            push_transaction,
+            push_scheduled_transaction,
+            finalize_block,
+            process_block_usage,
+            set_action_merkle,
+            set_trx_merkle,
+            commit_block,
+            emit_pre_accepted_block,
+            emit_accepted_block_header,
+            emit_accepted_block,
+            emit_irreversible_block,
+            emit_accepted_transaction,
+            emit_applied_transaction,
+            emit_accepted_confirmation,
+            emit_other,
+            stage_count
+         };
+
+         enum counter_type {
+            trx_applied,            ///< executed, or delayed, and included in the pending block
+            trx_failed,             ///< objective failure: rejected input transaction, or hard/soft failed deferred one
+            trx_expired,            ///< deferred transaction retired as expired
+            trx_subjective_failed,  ///< failure that may succeed later (deadline, block full, ...), not recorded in the block
+            counter_count
+         };
+
+         /// bucket i counts samples below 2^i microseconds, the last bucket counts everything else
+         static constexpr size_t bucket_count = 24;
+
+         struct histogram {
+            string            stage;
+            uint64_t          count  = 0;
+            uint64_t          sum_us = 0;
+            uint64_t          max_us = 0;
+            vector<uint64_t>  buckets;  ///< non cumulative, see bucket_count
+         };
+
+         struct snapshot {
+            vector<histogram> stages;
+            uint64_t          trx_applied           = 0;
+            uint64_t          trx_failed            = 0;
+            uint64_t          trx_expired           = 0;
+            uint64_t          trx_subjective_failed = 0;
+         };
+
+         /// records the time from construction to destruction into stage
+         class scoped_timer {
+            public:
+               scoped_timer( controller_metrics& m, stage_type s )
+               :_metrics(m),_stage(s),_start(std::chrono::steady_clock::now()) {}
+
+               ~scoped_timer() {
+                  _metrics.record( _stage, std::chrono::duration_cast<std::chrono::microseconds>(
+                                              std::chrono::steady_clock::now() - _start ).count() );
+               }
+
+               scoped_timer( const scoped_timer& ) = delete;
+               scoped_timer& operator=( const scoped_timer& ) = delete;
+
+            private:
+               controller_metrics&                    _metrics;
+               stage_type                             _stage;
+               std::chrono::steady_clock::time_point  _start;
+         };
+
+         void record( stage_type s, int64_t elapsed_us );
+         void increment( counter_type c ) { _counters[c].fetch_add( 1, std::memory_order_relaxed ); }
+
+         snapshot get_snapshot()const;
+
+         /// Prometheus text exposition format (version 0.0.4)
+         string to_prometheus()const;
+
+         static const char* stage_name( stage_type s );
+
+      private:
+         struct stage_stats {
+            std::atomic<uint64_t>                           count{0};
+            std::atomic<uint64_t>                           sum_us{0};
+            std::atomic<uint64_t>                           max_us{0};
+            std::array<std::atomic<uint64_t>, bucket_count> buckets{};
+         };
+
+         std::array<stage_stats, stage_count>             _stages;
+         std::array<std::atomic<uint64_t>, counter_count> _counters{};
+   };
+
+} } /// snax::chain
+
+FC_REFLECT( snax::chain::controller_metrics::histogram, (stage)(count)(sum_us)(max_us)(buckets) )
+FC_REFLECT( snax::chain::controller_metrics::snapshot, (stages)(trx_applied)(trx_failed)(trx_expired)(trx_subjective_failed) )
@@ -19,4 +19,33 @@ namespace snax { namespace chain {
     */
    digest_type merkle( vector<digest_type> ids );
 
+   /**
+    *  Builds the same root as merkle() one leaf at a time, so the hashing can be spread over block assembly.
+    *
+    *  Only the roots of complete subtrees are kept (at most one per level); appending costs one hash amortized
+    *  and root() combines the kept subtrees in O(log n). Copy it to keep a point to roll back to.
+    */
+   class merkle_accumulator {
+      public:
+         void append( const digest_type& leaf );
+
+         digest_type root()const;
+
+         size_t size()const { return _leaf_count; }
+
+         void reset() {
+            _leaf_count = 0;
+            _subtrees.clear();
+         }
+
+      private:
+         struct subtree {
+            digest_type  root;
+            uint32_t     height = 0;
+         };
+
+         size_t           _leaf_count = 0;
+         vector<subtree>  _subtrees; ///< strictly decreasing heights, mirrors the binary representation of _leaf_count
+   };
+
 } } /// snax::chain
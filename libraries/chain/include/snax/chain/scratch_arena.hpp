@@ -0,0 +1,84 @@
+/**
+ *  @file
+ *  @copyright defined in snax/LICENSE.txt
+ */
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace snax { namespace chain {
+
+   /**
+    *  Bump allocator for short lived scratch containers. Memory is handed out from blocks of
+    *  block_size bytes, deallocation is a no-op and every block is released at once when the
+    *  arena is destroyed.
+    *
+    *  Not thread safe; each transaction_context owns one for the apply_contexts of its actions.
+    */
+   class scratch_arena {
+      public:
+         explicit scratch_arena( size_t block_size = 4096 )
+         :_block_size( block_size ) {}
+
+         scratch_arena( const scratch_arena& ) = delete;
+         scratch_arena& operator=( const scratch_arena& ) = delete;
+
+         void* allocate( size_t bytes, size_t alignment ) {
+            auto pos = (reinterpret_cast<uintptr_t>(_next) + alignment - 1) & ~uintptr_t(alignment - 1);
+            if( _next == nullptr || pos + bytes > reinterpret_cast<uintptr_t>(_end) ) {
+               // requests larger than a block get a block of their own
+               size_t size = std::max( _block_size, bytes + alignment );
+               _blocks.emplace_back( new char[size] );
+               _next = _blocks.back().get();
+               _end  = _next + size;
+               pos = (reinterpret_cast<uintptr_t>(_next) + alignment - 1) & ~uintptr_t(alignment - 1);
+            }
+            _next = reinterpret_cast<char*>( pos + bytes );
+            return reinterpret_cast<void*>( pos );
+         }
+
+         /// number of blocks taken from the heap so far
+         size_t block_count()const { return _blocks.size(); }
+
+      private:
+         size_t                          _block_size;
+         char*                           _next = nullptr;
+         char*                           _end  = nullptr;
+         std::vector<std::unique_ptr<char[]>> _blocks;
+   };
+
+   template<typename T>
+   class scratch_allocator {
+      public:
+         using value_type = T;
+
+         explicit scratch_allocator( scratch_arena& arena ) : _arena( &arena ) {}
+
+         template<typename U>
+         scratch_allocator( const scratch_allocator<U>& other ) : _arena( other._arena ) {}
+
+         T* allocate( size_t n ) {
+            return static_cast<T*>( _arena->allocate( n * sizeof(T), alignof(T) ) );
+         }
+
+         void deallocate( T*, size_t ) {}
+
+         template<typename U>
+         bool operator==( const scratch_allocator<U>& other )const { return _arena == other._arena; }
+         template<typename U>
+         bool operator!=( const scratch_allocator<U>& other )const { return _arena != other._arena; }
+
+      private:
+         template<typename U> friend class scratch_allocator;
+
+         scratch_arena* _arena;
+   };
+
+   template<typename T>
+   using scratch_vector = std::vector<T, scratch_allocator<T>>;
+
+} } // namespace snax::chain
@@ -0,0 +1,71 @@
+/**
+ *  @file
+ *  @copyright defined in snax/LICENSE.txt
+ */
+#pragma once
+#include <snax/chain/types.hpp>
+
+#include <atomic>
+#include <memory>
+
+namespace snax { namespace chain {
+
+   /**
+    *  Process-wide cache of public keys recovered from transaction signatures.
+    *
+    *  Entries are keyed by signature and validated against the signed digest, so a key recovered
+    *  by any thread (speculative execution, block validation or an incoming-transaction worker)
+    *  is reused by every other thread. The cache is split into shards selected by the digest, each
+    *  guarded by its own mutex; all signatures of one transaction therefore land in the same shard.
+    *
+    *  Entries are evicted oldest-first when a shard exceeds its share of the capacity, and as soon
+    *  as the transaction that carried the signature has expired.
+    */
+   class signature_recovery_cache {
+      public:
+         struct stats {
+            uint64_t hits        = 0;
+            uint64_t misses      = 0;
+            uint64_t evictions   = 0;
+            uint64_t expirations = 0;
+            uint64_t size        = 0;
+            uint64_t capacity    = 0;
+         };
+
+         static signature_recovery_cache& instance();
+
+         ~signature_recovery_cache();
+
+         void set_capacity( size_t capacity );
+
+         /**
+          *  @return the key that produced sig over digest, recovering it and caching it on a miss
+          */
+         public_key_type recover( const signature_type& sig, const digest_type& digest, time_point_sec expiration );
+
+         /**
+          *  Remove all entries of transactions that expired before now
+          */
+         void remove_expired( time_point_sec now );
+
+         stats get_stats()const;
+
+      private:
+         signature_recovery_cache();
+
+         struct shard;
+         static constexpr size_t shard_count = 16;
+
+         shard& get_shard( const digest_type& digest );
+
+         std::unique_ptr<shard[]>  _shards;
+         std::atomic<size_t>       _shard_capacity;
+         std::atomic<uint64_t>     _hits{0};
+         std::atomic<uint64_t>     _misses{0};
+         std::atomic<uint64_t>     _evictions{0};
+         std::atomic<uint64_t>     _expirations{0};
+   };
+
+} } /// snax::chain
+
+FC_REFLECT( snax::chain::signature_recovery_cache::stats, (hits)(misses)(evictions)(expirations)(size)(capacity) )
@@ -130,19 +130,27 @@ namespace snax { namespace chain {
       bytes                                   packed_context_free_data;
       bytes                                   packed_trx;
 
-      time_point_sec     expiration()const;
-      transaction_id_type id()const;
+      time_point_sec     expiration()const; // thread safe
+      transaction_id_type id()const; // thread safe
       transaction_id_type get_uncached_id()const; // thread safe
       bytes              get_raw_transaction()const; // thread safe
       vector<bytes>      get_context_free_data()const;
-      transaction        get_transaction()const;
-      signed_transaction get_signed_transaction()const;
+      transaction        get_transaction()const; // thread safe
+      signed_transaction get_signed_transaction()const; // thread safe
       void               set_transaction(const transaction& t, compression_type _compression = none);
       void               set_transaction(const transaction& t, const vector<bytes>& cfd, compression_type _compression = none);
 
+      /// called once unpacked, before the object can be shared with other threads
+      void               reflector_verify()const;
+
    private:
-      mutable optional<transaction>           unpacked_trx; // <-- intermediate buffer used to retrieve values
-      void local_unpack()const;
+      /// only the values derived from the unpacked transaction are cached, not the transaction itself, so
+      /// a packed_transaction costs little more than its packed bytes wherever it is held; they are set by
+      /// set_transaction and reflector_verify only, never by the accessors
+      mutable optional<transaction_id_type>   cached_id;
+      mutable optional<time_point_sec>        cached_expiration;
+      void cache_values( const transaction& t )const;
+      transaction unpack_packed_trx()const;
    };
 
    using packed_transaction_ptr = std::shared_ptr<packed_transaction>;
@@ -1,10 +1,18 @@
 #pragma once
 #include <snax/chain/controller.hpp>
 #include <snax/chain/trace.hpp>
-#include <signal.h>
+#include <snax/chain/scratch_arena.hpp>
+#include <atomic>
 
 namespace snax { namespace chain {
 
+   struct deadline_thread_timer;
+
+   /**
+    *  Sets expired once the deadline passes. On Linux each thread has its own timer, shared by every
+    *  deadline_timer created on that thread, so transactions can execute on several threads; elsewhere
+    *  a single process-wide timer is used and only one thread at a time may run with a deadline.
+    */
    struct deadline_timer {
          deadline_timer();
          ~deadline_timer();
@@ -12,10 +20,9 @@ namespace snax { namespace chain {
          void start(fc::time_point tp);
          void stop();
 
-         static volatile sig_atomic_t expired;
+         std::atomic_bool&       expired;
       private:
-         static void timer_expired(int);
-         static bool initialized;
+         deadline_thread_timer&  _timer;
    };
 
    class transaction_context {
@@ -126,6 +133,9 @@ namespace snax { namespace chain {
          fc::microseconds              billing_timer_duration_limit;
 
          deadline_timer                _deadline_timer;
+
+         /// backs the notification and inline action queues of every apply_context of this transaction
+         scratch_arena                 _scratch;
    };
 
 } }
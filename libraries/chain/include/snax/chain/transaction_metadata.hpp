@@ -12,13 +12,17 @@ namespace snax { namespace chain {
 /**
  *  This data structure should store context-free cached data about a transaction such as
  *  packed/unpacked/compressed and recovered keys
+ *
+ *  The packed form is shared (by pointer) with the producer, net and bnet plugins,
+ *  so a transaction received from the network is held packed exactly once.  The unpacked
+ *  form is decoded once from it, ids are derived once at construction.
  */
 class transaction_metadata {
    public:
       transaction_id_type                                        id;
       transaction_id_type                                        signed_id;
+      packed_transaction_ptr                                     packed_trx; ///< shared, never modified after construction
       signed_transaction                                         trx;
-      packed_transaction                                         packed_trx;
       optional<pair<chain_id_type, flat_set<public_key_type>>>   signing_keys;
       std::future<pair<chain_id_type,flat_set<public_key_type>>> signing_keys_future;
       bool                                                       accepted = false;
@@ -26,19 +30,20 @@ class transaction_metadata {
       bool                                                       scheduled = false;
 
       explicit transaction_metadata( const signed_transaction& t, packed_transaction::compression_type c = packed_transaction::none )
-      :trx(t),packed_trx(t, c) {
+      :packed_trx(std::make_shared<packed_transaction>(t, c)), trx(t) {
          id = trx.id();
-         //raw_packed = fc::raw::pack( static_cast<const transaction&>(trx) );
-         signed_id = digest_type::hash(packed_trx);
+         signed_id = digest_type::hash(*packed_trx);
       }
 
-      explicit transaction_metadata( const packed_transaction& ptrx )
-      :trx( ptrx.get_signed_transaction() ), packed_trx(ptrx) {
+      explicit transaction_metadata( const packed_transaction_ptr& ptrx )
+      :packed_trx(ptrx), trx( ptrx->get_signed_transaction() ) {
          id = trx.id();
-         //raw_packed = fc::raw::pack( static_cast<const transaction&>(trx) );
-         signed_id = digest_type::hash(packed_trx);
+         signed_id = digest_type::hash(*packed_trx);
       }
 
+      explicit transaction_metadata( const packed_transaction& ptrx )
+      :transaction_metadata( std::make_shared<packed_transaction>(ptrx) ) {}
+
       const flat_set<public_key_type>& recover_keys( const chain_id_type& chain_id ) {
          // Unlikely for more than one chain_id to be used in one snaxnode instance
          if( !signing_keys || signing_keys->first != chain_id ) {
@@ -49,4 +49,40 @@ digest_type merkle(vector<digest_type> ids) {
    return ids.front();
 }
 
+void merkle_accumulator::append( const digest_type& leaf ) {
+   _subtrees.push_back( subtree{ leaf, 0 } );
+   ++_leaf_count;
+
+   while( _subtrees.size() > 1 ) {
+      auto& right = _subtrees.back();
+      auto& left  = _subtrees[_subtrees.size() - 2];
+      if( left.height != right.height )
+         break;
+      left.root = digest_type::hash(make_canonical_pair(left.root, right.root));
+      ++left.height;
+      _subtrees.pop_back();
+   }
+}
+
+digest_type merkle_accumulator::root()const {
+   if( _subtrees.empty() ) { return digest_type(); }
+
+   // fold from the smallest complete subtree upwards; a node without a complete left sibling is the last of its
+   // level in merkle() and is paired with itself
+   auto itr = _subtrees.rbegin();
+   digest_type top = itr->root;
+   uint32_t height = itr->height;
+   ++itr;
+   for( ; itr != _subtrees.rend(); ++itr ) {
+      while( height < itr->height ) {
+         top = digest_type::hash(make_canonical_pair(top, top));
+         ++height;
+      }
+      top = digest_type::hash(make_canonical_pair(itr->root, top));
+      ++height;
+   }
+
+   return top;
+}
+
 } } // snax::chain
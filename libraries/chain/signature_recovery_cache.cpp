@@ -0,0 +1,148 @@
+/**
+ *  @file
+ *  @copyright defined in snax/LICENSE.txt
+ */
+#include <snax/chain/signature_recovery_cache.hpp>
+#include <snax/chain/config.hpp>
+
+#include <boost/multi_index_container.hpp>
+#include <boost/multi_index/sequenced_index.hpp>
+#include <boost/multi_index/hashed_index.hpp>
+#include <boost/multi_index/ordered_index.hpp>
+#include <boost/multi_index/member.hpp>
+
+#include <mutex>
+
+namespace snax { namespace chain {
+
+using namespace boost::multi_index;
+
+namespace {
+
+   struct cached_pub_key {
+      signature_type  sig;
+      digest_type     digest;
+      public_key_type pub_key;
+      time_point_sec  expiration;
+   };
+
+   struct by_sig;
+   struct by_expiration;
+
+   typedef multi_index_container<
+      cached_pub_key,
+      indexed_by<
+         sequenced<>,
+         hashed_unique<
+            tag<by_sig>,
+            member<cached_pub_key, signature_type, &cached_pub_key::sig>
+         >,
+         ordered_non_unique<
+            tag<by_expiration>,
+            member<cached_pub_key, time_point_sec, &cached_pub_key::expiration>
+         >
+      >
+   > recovery_cache_type;
+
+}
+
+struct signature_recovery_cache::shard {
+   mutable std::mutex   mtx;
+   recovery_cache_type  entries;
+};
+
+signature_recovery_cache& signature_recovery_cache::instance() {
+   static signature_recovery_cache cache;
+   return cache;
+}
+
+signature_recovery_cache::signature_recovery_cache()
+:_shards( new shard[shard_count] )
+,_shard_capacity( std::max<size_t>( config::default_sig_cache_size / shard_count, 1 ) )
+{}
+
+signature_recovery_cache::~signature_recovery_cache() = default;
+
+void signature_recovery_cache::set_capacity( size_t capacity ) {
+   const size_t shard_capacity = std::max<size_t>( capacity / shard_count, 1 );
+   _shard_capacity = shard_capacity;
+
+   for( size_t i = 0; i < shard_count; ++i ) {
+      auto& s = _shards[i];
+      std::lock_guard<std::mutex> g( s.mtx );
+      while( s.entries.size() > shard_capacity ) {
+         s.entries.pop_front();
+         ++_evictions;
+      }
+   }
+}
+
+signature_recovery_cache::shard& signature_recovery_cache::get_shard( const digest_type& digest ) {
+   return _shards[digest._hash[0] % shard_count];
+}
+
+public_key_type signature_recovery_cache::recover( const signature_type& sig, const digest_type& digest, time_point_sec expiration ) {
+   auto& s = get_shard( digest );
+   {
+      std::lock_guard<std::mutex> g( s.mtx );
+      auto& by_sig_idx = s.entries.get<by_sig>();
+      auto itr = by_sig_idx.find( sig );
+      if( itr != by_sig_idx.end() && itr->digest == digest ) {
+         ++_hits;
+         return itr->pub_key;
+      }
+   }
+
+   // recover outside of the lock, another thread may do the same work concurrently which is harmless
+   ++_misses;
+   public_key_type recov( sig, digest );
+
+   std::lock_guard<std::mutex> g( s.mtx );
+   auto& by_sig_idx = s.entries.get<by_sig>();
+   auto itr = by_sig_idx.find( sig );
+   if( itr != by_sig_idx.end() ) {
+      by_sig_idx.modify( itr, [&]( cached_pub_key& c ) {
+         c.digest = digest;
+         c.pub_key = recov;
+         c.expiration = std::max( c.expiration, expiration );
+      });
+   } else {
+      s.entries.push_back( cached_pub_key{sig, digest, recov, expiration} );
+   }
+
+   const size_t shard_capacity = _shard_capacity;
+   while( s.entries.size() > shard_capacity ) {
+      s.entries.pop_front();
+      ++_evictions;
+   }
+
+   return recov;
+}
+
+void signature_recovery_cache::remove_expired( time_point_sec now ) {
+   for( size_t i = 0; i < shard_count; ++i ) {
+      auto& s = _shards[i];
+      std::lock_guard<std::mutex> g( s.mtx );
+      auto& by_exp_idx = s.entries.get<by_expiration>();
+      auto end = by_exp_idx.lower_bound( now );
+      _expirations += static_cast<uint64_t>( std::distance( by_exp_idx.begin(), end ) );
+      by_exp_idx.erase( by_exp_idx.begin(), end );
+   }
+}
+
+signature_recovery_cache::stats signature_recovery_cache::get_stats()const {
+   stats result;
+   result.hits        = _hits;
+   result.misses      = _misses;
+   result.evictions   = _evictions;
+   result.expirations = _expirations;
+   result.capacity    = _shard_capacity * shard_count;
+   for( size_t i = 0; i < shard_count; ++i ) {
+      auto& s = _shards[i];
+      std::lock_guard<std::mutex> g( s.mtx );
+      result.size += s.entries.size();
+   }
+   return result;
+}
+
+} } /// snax::chain
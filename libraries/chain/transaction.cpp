@@ -8,10 +8,6 @@
 #include <algorithm>
 
 #include <boost/range/adaptor/transformed.hpp>
-#include <boost/multi_index_container.hpp>
-#include <boost/multi_index/sequenced_index.hpp>
-#include <boost/multi_index/hashed_index.hpp>
-#include <boost/multi_index/member.hpp>
 #include <boost/iostreams/filtering_stream.hpp>
 #include <boost/iostreams/device/back_inserter.hpp>
 #include <boost/iostreams/filter/zlib.hpp>
@@ -19,35 +15,10 @@
 #include <snax/chain/config.hpp>
 #include <snax/chain/exceptions.hpp>
 #include <snax/chain/transaction.hpp>
+#include <snax/chain/signature_recovery_cache.hpp>
 
 namespace snax { namespace chain {
 
-using namespace boost::multi_index;
-
-struct cached_pub_key {
-   transaction_id_type trx_id;
-   public_key_type pub_key;
-   signature_type sig;
-   cached_pub_key(const cached_pub_key&) = delete;
-   cached_pub_key() = delete;
-   cached_pub_key& operator=(const cached_pub_key&) = delete;
-   cached_pub_key(cached_pub_key&&) = default;
-};
-struct by_sig{};
-
-typedef multi_index_container<
-   cached_pub_key,
-   indexed_by<
-      sequenced<>,
-      hashed_unique<
-         tag<by_sig>,
-         member<cached_pub_key,
-                signature_type,
-                &cached_pub_key::sig>
-      >
-   >
-> recovery_cache_type;
-
 void transaction_header::set_reference_block( const block_id_type& reference_block ) {
    ref_block_num    = fc::endian_reverse_u32(reference_block._hash[0]);
    ref_block_prefix = reference_block._hash[1];
@@ -86,24 +57,13 @@ flat_set<public_key_type> transaction::get_signature_keys( const vector<signatur
 { try {
    using boost::adaptors::transformed;
 
-   constexpr size_t recovery_cache_size = 1000;
-   static thread_local recovery_cache_type recovery_cache;
+   auto& recovery_cache = signature_recovery_cache::instance();
    const digest_type digest = sig_digest(chain_id, cfd);
 
    flat_set<public_key_type> recovered_pub_keys;
    for(const signature_type& sig : signatures) {
-      public_key_type recov;
-      if( use_cache ) {
-         recovery_cache_type::index<by_sig>::type::iterator it = recovery_cache.get<by_sig>().find( sig );
-         if( it == recovery_cache.get<by_sig>().end() || it->trx_id != id()) {
-            recov = public_key_type( sig, digest );
-            recovery_cache.emplace_back(cached_pub_key{id(), recov, sig} ); //could fail on dup signatures; not a problem
-         } else {
-            recov = it->pub_key;
-         }
-      } else {
-         recov = public_key_type( sig, digest );
-      }
+      public_key_type recov = use_cache ? recovery_cache.recover( sig, digest, expiration )
+                                        : public_key_type( sig, digest );
       bool successful_insertion = false;
       std::tie(std::ignore, successful_insertion) = recovered_pub_keys.insert(recov);
       SNAX_ASSERT( allow_duplicate_keys || successful_insertion, tx_duplicate_sig,
@@ -112,11 +72,6 @@ flat_set<public_key_type> transaction::get_signature_keys( const vector<signatur
                );
    }
 
-   if( use_cache ) {
-      while ( recovery_cache.size() > recovery_cache_size )
-         recovery_cache.erase( recovery_cache.begin() );
-   }
-
    return recovered_pub_keys;
 } FC_CAPTURE_AND_RETHROW() }
 
@@ -288,44 +243,57 @@ vector<bytes> packed_transaction::get_context_free_data()const
 
 time_point_sec packed_transaction::expiration()const
 {
-   local_unpack();
-   return unpacked_trx->expiration;
+   if( cached_expiration )
+      return *cached_expiration;
+   return unpack_packed_trx().expiration;
 }
 
 transaction_id_type packed_transaction::id()const
 {
-   local_unpack();
-   return get_transaction().id();
+   if( cached_id )
+      return *cached_id;
+   return get_uncached_id();
 }
 
 transaction_id_type packed_transaction::get_uncached_id()const
 {
-   const auto raw = get_raw_transaction();
-   return fc::raw::unpack<transaction>( raw ).id();
+   return unpack_packed_trx().id();
 }
 
-void packed_transaction::local_unpack()const
+void packed_transaction::cache_values( const transaction& t )const
 {
-   if (!unpacked_trx) {
-      try {
-         switch(compression) {
+   cached_expiration = t.expiration;
+   cached_id = t.id();
+}
+
+void packed_transaction::reflector_verify()const
+{
+   cached_id.reset();
+   cached_expiration.reset();
+   try {
+      cache_values( unpack_packed_trx() );
+   } catch( const fc::exception& ) {
+      // leave the values uncached, so that the same error is raised where the transaction is used
+   }
+}
+
+transaction packed_transaction::unpack_packed_trx()const
+{
+   try {
+      switch(compression) {
          case none:
-            unpacked_trx = unpack_transaction(packed_trx);
-            break;
+            return unpack_transaction(packed_trx);
          case zlib:
-            unpacked_trx = zlib_decompress_transaction(packed_trx);
-            break;
+            return zlib_decompress_transaction(packed_trx);
          default:
             SNAX_THROW(unknown_transaction_compression, "Unknown transaction compression algorithm");
-         }
-      } FC_CAPTURE_AND_RETHROW((compression)(packed_trx))
-   }
+      }
+   } FC_CAPTURE_AND_RETHROW((compression)(packed_trx))
 }
 
 transaction packed_transaction::get_transaction()const
 {
-   local_unpack();
-   return transaction(*unpacked_trx);
+   return unpack_packed_trx();
 }
 
 signed_transaction packed_transaction::get_signed_transaction() const
@@ -333,9 +301,9 @@ signed_transaction packed_transaction::get_signed_transaction() const
    try {
       switch(compression) {
          case none:
-            return signed_transaction(get_transaction(), signatures, unpack_context_free_data(packed_context_free_data));
+            return signed_transaction(unpack_packed_trx(), signatures, unpack_context_free_data(packed_context_free_data));
          case zlib:
-            return signed_transaction(get_transaction(), signatures, zlib_decompress_context_free_data(packed_context_free_data));
+            return signed_transaction(unpack_packed_trx(), signatures, zlib_decompress_context_free_data(packed_context_free_data));
          default:
             SNAX_THROW(unknown_transaction_compression, "Unknown transaction compression algorithm");
       }
@@ -359,6 +327,7 @@ void packed_transaction::set_transaction(const transaction& t, packed_transactio
    } FC_CAPTURE_AND_RETHROW((_compression)(t))
    packed_context_free_data.clear();
    compression = _compression;
+   cache_values( t );
 }
 
 void packed_transaction::set_transaction(const transaction& t, const vector<bytes>& cfd, packed_transaction::compression_type _compression)
@@ -378,6 +347,7 @@ void packed_transaction::set_transaction(const transaction& t, const vector<byte
       }
    } FC_CAPTURE_AND_RETHROW((_compression)(t))
    compression = _compression;
+   cache_values( t );
 }
 
 
@@ -18,39 +18,130 @@
 #pragma pop_macro("N")
 
 #include <chrono>
+#include <mutex>
+#include <signal.h>
+#include <string.h>
+
+#if defined(__linux__)
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <time.h>
+#ifndef sigev_notify_thread_id
+#define sigev_notify_thread_id _sigev_un._tid
+#endif
+#else
+#include <sys/time.h>
+#endif
 
 namespace snax { namespace chain {
 
 namespace bacc = boost::accumulators;
 
+   /**
+    *  A POSIX timer that signals only the thread that created it with a queued real-time signal, so
+    *  concurrent expirations on different threads are never merged. Created on first use by a thread and
+    *  intentionally never freed: a signal raised just before its thread exits must not write freed memory.
+    *
+    *  Without per-thread timers (anything but Linux) the process-wide ITIMER_REAL/SIGALRM timer is used as
+    *  before, which sets the flag of the thread that armed it last; only one thread at a time may then run
+    *  with a deadline.
+    */
+   struct deadline_thread_timer {
+      std::atomic_bool  expired{false};
+      bool              valid = false;
+#if defined(__linux__)
+      timer_t           id;
+#endif
+
+      deadline_thread_timer() {
+#if defined(__linux__)
+         struct sigevent sev;
+         memset(&sev, 0, sizeof(sev));
+         sev.sigev_notify = SIGEV_THREAD_ID;
+         sev.sigev_signo = SIGRTMIN;
+         sev.sigev_value.sival_ptr = &expired;
+         sev.sigev_notify_thread_id = syscall(SYS_gettid);
+         valid = timer_create(CLOCK_MONOTONIC, &sev, &id) == 0;
+#else
+         valid = true;
+#endif
+      }
+
+      /// arm the timer to fire in us microseconds, 0 disarms it
+      bool arm(int64_t us) {
+#if defined(__linux__)
+         struct itimerspec spec = {{0, 0}, {time_t(us / 1000000), long(us % 1000000) * 1000}};
+         return valid && timer_settime(id, 0, &spec, NULL) == 0;
+#else
+         if(us > 0)
+            alarm_flag() = &expired;
+         struct itimerval spec = {{0, 0}, {time_t(us / 1000000), suseconds_t(us % 1000000)}};
+         return setitimer(ITIMER_REAL, &spec, NULL) == 0;
+#endif
+      }
+
+#if defined(__linux__)
+      static void timer_expired(int, siginfo_t* info, void*) {
+         auto* flag = static_cast<std::atomic_bool*>(info->si_value.sival_ptr);
+         if(flag)
+            *flag = true;
+      }
+#else
+      /// flag of the thread that armed the process-wide timer last
+      static std::atomic<std::atomic_bool*>& alarm_flag() {
+         static std::atomic<std::atomic_bool*> flag{nullptr};
+         return flag;
+      }
+
+      static void timer_expired(int) {
+         auto* flag = alarm_flag().load();
+         if(flag)
+            *flag = true;
+      }
+#endif
+
+      static bool install_handler() {
+         struct sigaction act;
+         sigemptyset(&act.sa_mask);
+#if defined(__linux__)
+         act.sa_sigaction = timer_expired;
+         act.sa_flags = SA_SIGINFO | SA_RESTART;
+         return sigaction(SIGRTMIN, &act, NULL) == 0;
+#else
+         act.sa_handler = timer_expired;
+         act.sa_flags = 0;
+         return sigaction(SIGALRM, &act, NULL) == 0;
+#endif
+      }
+
+      static deadline_thread_timer& current() {
+         static thread_local deadline_thread_timer* timer = new deadline_thread_timer;
+         return *timer;
+      }
+   };
+
    struct deadline_timer_verify {
       deadline_timer_verify() {
          //keep longest first in list. You're effectively going to take test_intervals[0]*sizeof(test_intervals[0])
          //time to do the the "calibration"
          int test_intervals[] = {50000, 10000, 5000, 1000, 500, 100, 50, 10};
 
-         struct sigaction act;
-         sigemptyset(&act.sa_mask);
-         act.sa_handler = timer_hit;
-         act.sa_flags = 0;
-         if(sigaction(SIGALRM, &act, NULL))
+         if(!deadline_thread_timer::install_handler())
             return;
 
-         sigset_t alrm;
-         sigemptyset(&alrm);
-         sigaddset(&alrm, SIGALRM);
-         int dummy;
+         auto& timer = deadline_thread_timer::current();
+         if(!timer.valid)
+            return;
 
          for(int& interval : test_intervals) {
             unsigned int loops = test_intervals[0]/interval;
 
             for(unsigned int i = 0; i < loops; ++i) {
-               struct itimerval enable = {{0, 0}, {0, interval}};
-               hit = 0;
+               timer.expired = false;
                auto start = std::chrono::high_resolution_clock::now();
-               if(setitimer(ITIMER_REAL, &enable, NULL))
+               if(!timer.arm(interval))
                   return;
-               while(!hit) {}
+               while(!timer.expired) {}
                auto end = std::chrono::high_resolution_clock::now();
                int timer_slop = std::chrono::duration_cast<std::chrono::microseconds>(end-start).count() - interval;
 
@@ -64,87 +155,65 @@ namespace bacc = boost::accumulators;
                samples(timer_slop, bacc::weight = interval/(float)test_intervals[0]);
             }
          }
+         timer.expired = false;
          timer_overhead = bacc::mean(samples) + sqrt(bacc::variance(samples))*2; //target 95% of expirations before deadline
          use_deadline_timer = timer_overhead < 1000;
-
-         act.sa_handler = SIG_DFL;
-         sigaction(SIGALRM, &act, NULL);
-      }
-
-      static void timer_hit(int) {
-         hit = 1;
       }
-      static volatile sig_atomic_t hit;
 
       bacc::accumulator_set<int, bacc::stats<bacc::tag::mean, bacc::tag::min, bacc::tag::max, bacc::tag::variance>, float> samples;
       bool use_deadline_timer = false;
-      int timer_overhead;
+      int timer_overhead = 0;
    };
-   volatile sig_atomic_t deadline_timer_verify::hit;
    static deadline_timer_verify deadline_timer_verification;
 
-   deadline_timer::deadline_timer() {
-      if(initialized)
-         return;
-      initialized = true;
-
-      #define TIMER_STATS_FORMAT "min:${min}us max:${max}us mean:${mean}us stddev:${stddev}us"
-      #define TIMER_STATS \
-         ("min", bacc::min(deadline_timer_verification.samples))("max", bacc::max(deadline_timer_verification.samples)) \
-         ("mean", (int)bacc::mean(deadline_timer_verification.samples))("stddev", (int)sqrt(bacc::variance(deadline_timer_verification.samples))) \
-         ("t", deadline_timer_verification.timer_overhead)
-
-      if(deadline_timer_verification.use_deadline_timer) {
-         struct sigaction act;
-         act.sa_handler = timer_expired;
-         sigemptyset(&act.sa_mask);
-         act.sa_flags = 0;
-         if(sigaction(SIGALRM, &act, NULL) == 0) {
+   deadline_timer::deadline_timer()
+   :expired(deadline_thread_timer::current().expired)
+   ,_timer(deadline_thread_timer::current())
+   {
+      static std::once_flag logged;
+      std::call_once(logged, []() {
+         #define TIMER_STATS_FORMAT "min:${min}us max:${max}us mean:${mean}us stddev:${stddev}us"
+         #define TIMER_STATS \
+            ("min", bacc::min(deadline_timer_verification.samples))("max", bacc::max(deadline_timer_verification.samples)) \
+            ("mean", (int)bacc::mean(deadline_timer_verification.samples))("stddev", (int)sqrt(bacc::variance(deadline_timer_verification.samples))) \
+            ("t", deadline_timer_verification.timer_overhead)
+
+         if(deadline_timer_verification.use_deadline_timer)
             ilog("Using ${t}us deadline timer for checktime: " TIMER_STATS_FORMAT, TIMER_STATS);
-            return;
-         }
-      }
-
-      wlog("Using polled checktime; deadline timer too inaccurate: " TIMER_STATS_FORMAT, TIMER_STATS);
-      deadline_timer_verification.use_deadline_timer = false; //set in case sigaction() fails above
+         else
+            wlog("Using polled checktime; deadline timer unavailable or too inaccurate: " TIMER_STATS_FORMAT, TIMER_STATS);
+      });
    }
 
    void deadline_timer::start(fc::time_point tp) {
       if(tp == fc::time_point::maximum()) {
-         expired = 0;
+         expired = false;
          return;
       }
-      if(!deadline_timer_verification.use_deadline_timer) {
-         expired = 1;
+      if(!deadline_timer_verification.use_deadline_timer || !_timer.valid) {
+         expired = true;
          return;
       }
       microseconds x = tp.time_since_epoch() - fc::time_point::now().time_since_epoch();
       if(x.count() <= deadline_timer_verification.timer_overhead)
-         expired = 1;
+         expired = true;
       else {
-         struct itimerval enable = {{0, 0}, {0, (int)x.count()-deadline_timer_verification.timer_overhead}};
-         expired = 0;
-         expired |= !!setitimer(ITIMER_REAL, &enable, NULL);
+         expired = false;
+         if(!_timer.arm(x.count()-deadline_timer_verification.timer_overhead))
+            expired = true;
       }
    }
 
    void deadline_timer::stop() {
       if(expired)
          return;
-      struct itimerval disable = {{0, 0}, {0, 0}};
-      setitimer(ITIMER_REAL, &disable, NULL);
+      _timer.arm(0);
    }
 
    deadline_timer::~deadline_timer() {
       stop();
    }
 
-   void deadline_timer::timer_expired(int) {
-      expired = 1;
-   }
-   volatile sig_atomic_t deadline_timer::expired = 0;
-   bool deadline_timer::initialized = false;
-
    transaction_context::transaction_context( controller& c,
                                              const signed_transaction& t,
                                              const transaction_id_type& trx_id,
@@ -269,7 +338,7 @@ namespace bacc = boost::accumulators;
       checktime(); // Fail early if deadline has already been exceeded
 
       if(control.skip_trx_checks())
-         _deadline_timer.expired = 0;
+         _deadline_timer.expired = false;
       else
          _deadline_timer.start(_deadline);
 
@@ -332,6 +401,10 @@ namespace bacc = boost::accumulators;
    void transaction_context::exec() {
       SNAX_ASSERT( is_initialized, transaction_exception, "must first initialize" );
 
+      // size the top level traces up front, moving action_traces (and their nested vectors) on growth is not free
+      trace->action_traces.reserve( (apply_context_free ? trx.context_free_actions.size() : 0)
+                                    + (delay == fc::microseconds() ? trx.actions.size() : 0) );
+
       if( apply_context_free ) {
          for( const auto& act : trx.context_free_actions ) {
             trace->action_traces.emplace_back();
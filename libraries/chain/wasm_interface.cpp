@@ -792,7 +792,9 @@ class permission_api : public context_aware_api {
                                          provided_permissions,
                                          fc::seconds(trx.delay_sec),
                                          std::bind(&transaction_context::checktime, &context.trx_context),
-                                         false
+                                         false,
+                                         flat_set<permission_level>(),
+                                         false // may run in a transaction that fails after changing the permissions checked
                                        );
             return true;
          } catch( const authorization_exception& e ) {}
@@ -824,7 +826,8 @@ class permission_api : public context_aware_api {
                                          provided_permissions,
                                          fc::microseconds(delay_us),
                                          std::bind(&transaction_context::checktime, &context.trx_context),
-                                         false
+                                         false,
+                                         false // may run in a transaction that fails after changing the permission checked
                                        );
             return true;
          } catch( const authorization_exception& e ) {}
@@ -43,6 +43,15 @@
  *     with its fork database and hopfully come to our conclusion.
  *  3. the peer will send us blocks on the same basis
  *
+ *  Header-first mode (bnet-header-first):
+ *  1. peers that ask for it get a block_header_announce as soon as a block
+ *     header is accepted, before the block itself has been applied
+ *  2. the producer signature of an announced header is validated on the
+ *     bnet threads and the body is requested from the first peer that
+ *     announced it, falling back to the next one if it does not arrive
+ *  3. blocks that are not fetched this way still arrive through the
+ *     regular stream
+ *
  */
 
 #include <snax/bnet_plugin/bnet_plugin.hpp>
@@ -113,6 +122,7 @@ using snax::block_timestamp_type;
 using std::string;
 using snax::sha256;
 using snax::signed_block_ptr;
+using snax::signed_block_header;
 using snax::packed_transaction_ptr;
 using std::vector;
 
@@ -134,7 +144,16 @@ struct hello_extension_irreversible_only {};
 
 FC_REFLECT( hello_extension_irreversible_only, BOOST_PP_SEQ_NIL )
 
-using hello_extension = fc::static_variant<hello_extension_irreversible_only>;
+/**
+ *  Asks the peer to announce new block headers as soon as they are accepted and
+ *  to answer block_request messages for them.
+ */
+struct hello_extension_header_first {};
+
+FC_REFLECT( hello_extension_header_first, BOOST_PP_SEQ_NIL )
+
+using hello_extension = fc::static_variant<hello_extension_irreversible_only,
+                                           hello_extension_header_first>;
 
 /**
  * This message is sent upon successful speculative application of a transaction
@@ -169,12 +188,34 @@ struct pong {
 };
 FC_REFLECT( pong, (sent)(code) )
 
+/**
+ *  Sent to peers that requested header-first mode when a block header is accepted
+ *  into the fork database, before the block is applied. Like block_notice it tells
+ *  the peer there is no need to send these blocks.
+ */
+struct block_header_announce {
+   vector<signed_block_header> headers;
+};
+
+FC_REFLECT( block_header_announce, (headers) )
+
+/**
+ *  Asks a peer that announced these block headers to send the full blocks.
+ */
+struct block_request {
+   vector<block_id_type> block_ids;
+};
+
+FC_REFLECT( block_request, (block_ids) )
+
 using bnet_message = fc::static_variant<hello,
                                         trx_notice,
                                         block_notice,
                                         signed_block_ptr,
                                         packed_transaction_ptr,
-                                        ping, pong
+                                        ping, pong,
+                                        block_header_announce,
+                                        block_request
                                         >;
 
 
@@ -269,6 +310,7 @@ namespace snax {
         block_id_type      _remote_lib_id;
         bool               _remote_request_trx    = false;
         bool               _remote_request_irreversible_only = false;
+        bool               _remote_header_first  = false;
 
         uint32_t           _last_sent_block_num   = 0;
         block_id_type      _last_sent_block_id; /// the id of the last block sent
@@ -302,6 +344,11 @@ namespace snax {
         //boost::beast::multi_buffer                                  _in_buffer;
         boost::beast::flat_buffer                                     _in_buffer;
         flat_set<block_id_type>                                       _block_header_notices;
+        vector<signed_block_header>                                   _header_announcements;
+        std::map<block_id_type, signed_block_ptr>                     _announced_blocks;    ///< blocks announced to peer, served on request
+        std::deque<signed_block_ptr>                                  _requested_blocks;    ///< blocks requested by peer, sent ahead of the block stream
+        flat_set<block_id_type>                                       _block_requests;      ///< block requests not yet sent to peer
+        flat_set<block_id_type>                                       _requested_block_ids; ///< blocks we requested from peer
         fc::optional<fc::variant_object>                              _logger_variant;
 
 
@@ -488,6 +535,19 @@ namespace snax {
               itr = idx.begin();
            }
 
+           for( auto aitr = _announced_blocks.begin(); aitr != _announced_blocks.end(); ) {
+              if( block_header::num_from_id( aitr->first ) <= _local_lib )
+                 aitr = _announced_blocks.erase( aitr );
+              else
+                 ++aitr;
+           }
+           for( auto ritr = _requested_block_ids.begin(); ritr != _requested_block_ids.end(); ) {
+              if( block_header::num_from_id( *ritr ) <= _local_lib )
+                 ritr = _requested_block_ids.erase( ritr );
+              else
+                 ++ritr;
+           }
+
            if( _remote_request_irreversible_only ) {
               auto bitr = _block_status.find(s->id);
               if ( bitr == _block_status.end() || !bitr->received_from_peer ) {
@@ -524,12 +584,32 @@ namespace snax {
            //   ilog( "queue notice to peer that we have this block so hopefully they don't send it to us" );
               auto itr = _block_status.find( id );
               if( !_remote_request_irreversible_only && ( itr == _block_status.end() || !itr->received_from_peer ) ) {
-                 _block_header_notices.insert( id );
+                 if( _remote_header_first ) {
+                    /// the announcement replaces the notice, keep the block around in case peer asks for it
+                    _header_announcements.emplace_back( *s->block );
+                    _announced_blocks[id] = s->block;
+                 } else {
+                    _block_header_notices.insert( id );
+                 }
               }
               if( itr == _block_status.end() ) {
                  _block_status.insert( block_status(id, false, false) );
               }
            }
+
+           if( _header_announcements.size() )
+              maybe_send_next_message(); /// announcing early is the point of header-first mode
+        }
+
+        /**
+         *  Called by bnet_plugin_impl when this peer is the one to fetch the body of
+         *  an announced header from.
+         */
+        void request_block( const block_id_type& id ) {
+           verify_strand_in_this_thread(_strand, __func__, __LINE__);
+           if( !_requested_block_ids.insert( id ).second ) return; /// already asked
+           _block_requests.insert( id );
+           maybe_send_next_message();
         }
 
         void on_accepted_block( const block_state_ptr& s ) {
@@ -593,6 +673,26 @@ namespace snax {
            });
         }
 
+        template<typename L>
+        void async_get_block_id( const block_id_type& id, L&& callback ) {
+           _app_ios.post( [self = shared_from_this(), id, callback]{
+              auto& control = app().get_plugin<chain_plugin>().chain();
+              signed_block_ptr sblockptr;
+              try {
+                 sblockptr = control.fetch_block_by_id( id );
+              } catch ( const fc::exception& e ) {
+                 edump((e.to_detail_string()));
+              }
+
+              self->_ios.post( boost::asio::bind_executor(
+                    self->_strand,
+                    [callback,sblockptr](){
+                       callback(sblockptr);
+                    }
+              ));
+           });
+        }
+
         template<typename L>
         void async_get_block_num( uint32_t blocknum, L&& callback ) {
            _app_ios.post( [self = shared_from_this(), blocknum, callback]{
@@ -625,15 +725,19 @@ namespace snax {
            send();
         } FC_LOG_AND_RETHROW() }
 
-        template<class T>
-        void send( const bnet_message& msg, const T& ex ) { try {
-           auto ex_size = fc::raw::pack_size(ex);
-           auto ps = fc::raw::pack_size(msg) + fc::raw::pack_size(unsigned_int(ex_size)) + ex_size;
+        void send( const bnet_message& msg, const vector<hello_extension>& exs ) { try {
+           auto ps = fc::raw::pack_size(msg);
+           for( const auto& ex : exs ) {
+              auto ex_size = fc::raw::pack_size(ex);
+              ps += fc::raw::pack_size(unsigned_int(ex_size)) + ex_size;
+           }
            _out_buffer.resize(ps);
            fc::datastream<char*> ds(_out_buffer.data(), ps);
            fc::raw::pack( ds, msg );
-           fc::raw::pack( ds, unsigned_int(ex_size) );
-           fc::raw::pack( ds, ex );
+           for( const auto& ex : exs ) {
+              fc::raw::pack( ds, unsigned_int(fc::raw::pack_size(ex)) );
+              fc::raw::pack( ds, ex );
+           }
            send();
         } FC_LOG_AND_RETHROW() }
 
@@ -682,8 +786,11 @@ namespace snax {
            clear_expired_trx();
 
            if( send_block_notice() ) return;
+           if( send_header_announce() ) return;
+           if( send_block_request() ) return;
            if( send_pong() ) return;
            if( send_ping() ) return;
+           if( send_requested_block() ) return;
 
            /// we don't know where we are (waiting on accept block localhost)
            if( _local_head_block_id == block_id_type() ) return ;
@@ -704,6 +811,43 @@ namespace snax {
            return true;
         }
 
+        bool send_header_announce() {
+           if( _header_announcements.size() == 0 )
+              return false;
+
+           block_header_announce announce;
+           announce.headers = std::move( _header_announcements );
+           _header_announcements.clear();
+           send(announce);
+           return true;
+        }
+
+        bool send_block_request() {
+           if( _block_requests.size() == 0 )
+              return false;
+
+           block_request request;
+           request.block_ids.reserve( _block_requests.size() );
+           for( auto& id : _block_requests )
+              request.block_ids.emplace_back(id);
+           send(request);
+           _block_requests.clear();
+           return true;
+        }
+
+        bool send_requested_block() {
+           if( _requested_blocks.empty() )
+              return false;
+
+           auto b = _requested_blocks.front();
+           _requested_blocks.pop_front();
+
+           mark_block_status( b->id(), true, false );
+           send( b );
+           status( "sending requested block " + std::to_string( b->block_num() ) );
+           return true;
+        }
+
         bool send_pong() {
            if( _last_recv_ping.code == fc::sha256() )
               return false;
@@ -765,7 +909,7 @@ namespace snax {
               return false;
 
 
-           auto ptrx_ptr = std::make_shared<packed_transaction>( start->trx->packed_trx );
+           auto ptrx_ptr = start->trx->packed_trx;
 
            idx.modify( start, [&]( auto& stat ) {
               stat.mark_known_by_peer();
@@ -945,6 +1089,12 @@ namespace snax {
                  case bnet_message::tag<pong>::value:
                     on( msg.get<pong>() );
                     break;
+                 case bnet_message::tag<block_header_announce>::value:
+                    on( msg.get<block_header_announce>() );
+                    break;
+                 case bnet_message::tag<block_request>::value:
+                    on( msg.get<block_request>() );
+                    break;
                  default:
                     wlog( "bad message received" );
                     _ws->close( boost::beast::websocket::close_code::bad_payload );
@@ -965,6 +1115,26 @@ namespace snax {
            }
         }
 
+        void on( const block_header_announce& announce );
+
+        void on( const block_request& request ) {
+           peer_ilog(this, "received block_request");
+           for( const auto& id : request.block_ids ) {
+              auto itr = _announced_blocks.find( id );
+              if( itr != _announced_blocks.end() ) {
+                 _requested_blocks.push_back( itr->second );
+                 continue;
+              }
+
+              /// not announced on this session, it may still be in the fork database
+              async_get_block_id( id, [self=shared_from_this()]( auto sblockptr ) {
+                 if( !sblockptr ) return;
+                 self->_requested_blocks.push_back( sblockptr );
+                 self->maybe_send_next_message();
+              });
+           }
+        }
+
         void on( const hello& hi, fc::datastream<const char*>& ds );
 
         void on( const ping& p ) {
@@ -1003,7 +1173,10 @@ namespace snax {
            status( "received block " + std::to_string(b->block_num()) );
            //ilog( "recv block ${n}", ("n", b->block_num()) );
            auto id = b->id();
-           mark_block_status( id, true, true );
+           /// a requested block may be relayed before the peer applied it, so the peer
+           /// is not held responsible (disconnected) if it turns out to be bad
+           const bool requested = _requested_block_ids.erase( id ) > 0;
+           mark_block_status( id, true, !requested );
 
            app().get_channel<incoming::channels::block>().publish(b);
 
@@ -1138,6 +1311,8 @@ namespace snax {
          uint16_t                                               _bnet_endpoint_port = 4321;
          bool                                                   _request_trx = true;
          bool                                                   _follow_irreversible = false;
+         bool                                                   _header_first = false;
+         fc::microseconds                                       _header_fetch_timeout = fc::milliseconds(500);
 
          std::vector<std::string>                               _connect_to_peers; /// list of peers to connect to
          std::vector<std::thread>                               _socket_threads;
@@ -1148,6 +1323,27 @@ namespace snax {
          std::shared_ptr<boost::asio::deadline_timer>           _timer;    // only access on app io_service
          std::map<const session*, std::weak_ptr<session> >      _sessions; // only access on app io_service
 
+         /**
+          *  A block whose header was announced to us and whose body we are fetching
+          */
+         struct header_fetch {
+            struct announcer {
+               const session*          key = nullptr;
+               std::weak_ptr<session>  ses;
+               bool                    verified = false;   ///< the header this peer announced is validly signed
+               bool                    requested = false;  ///< the body was requested from this peer
+            };
+
+            block_state_ptr                prev;                ///< the headers announced for this id are validated against
+            vector<announcer>              announcers;          ///< in order of arrival, the first is the fastest route to the block
+            vector<signature_type>         valid_signatures;    ///< of announced headers already validated
+            uint32_t                       verifying = 0;       ///< announced headers being validated
+            fc::time_point                 requested;           ///< when the body was last requested
+         };
+
+         std::map<block_id_type, header_fetch>                  _header_fetches; // only access on app io_service
+         std::shared_ptr<boost::asio::deadline_timer>           _header_fetch_timer; // only access on app io_service
+
          channels::irreversible_block::channel_type::handle     _on_irb_handle;
          channels::accepted_block::channel_type::handle         _on_accepted_block_handle;
          channels::accepted_block_header::channel_type::handle  _on_accepted_block_header_handle;
@@ -1193,6 +1389,13 @@ namespace snax {
           * can purge their block cache
           */
          void on_irreversible_block( block_state_ptr s ) {
+            if( _header_first ) {
+               app().get_io_service().post( [this, lib = s->block_num]{
+                  auto itr = _header_fetches.begin();
+                  while( itr != _header_fetches.end() && block_header::num_from_id( itr->first ) <= lib )
+                     itr = _header_fetches.erase( itr );
+               });
+            }
             for_each_session( [s]( auto ses ){ ses->on_new_lib( s ); } );
          }
 
@@ -1209,6 +1412,10 @@ namespace snax {
          }
 
          void on_accepted_block_header( block_state_ptr s ) {
+            if( _header_first ) {
+               /// the body arrived, from a requested peer or otherwise
+               app().get_io_service().post( [this, id = s->id]{ _header_fetches.erase( id ); } );
+            }
             _ioc->post( [s,this] { /// post this to the thread pool because packing can be intensive
                for_each_session( [s]( auto ses ){ ses->on_accepted_block_header( s ); } );
             });
@@ -1226,6 +1433,134 @@ namespace snax {
             for_each_session( [s]( auto ses ) { ses->on_bad_block(s); } );
          };
 
+         /**
+          *  A peer announced a block header. The block id does not cover the producer signature,
+          *  so the header of each announcer is validated on the bnet threads, unless it carries a
+          *  signature already found valid. The body is fetched from validated announcers only.
+          */
+         void on_header_announce( const std::shared_ptr<session>& ses, const signed_block_header& h, const block_id_type& id ) {
+            app().get_io_service().post( [this, key = ses.get(), wp = std::weak_ptr<session>(ses), h, id]{
+               auto itr = _header_fetches.find( id );
+               if( itr == _header_fetches.end() ) {
+                  auto& control = app().get_plugin<chain_plugin>().chain();
+                  if( control.fetch_block_state_by_id( id ) ) return; /// we already have it
+                  auto prev = control.fetch_block_state_by_id( h.previous );
+                  if( !prev ) return; /// cannot validate, the block will arrive through the regular stream
+                  itr = _header_fetches.emplace( id, header_fetch() ).first;
+                  itr->second.prev = prev;
+               }
+               auto& f = itr->second;
+               for( const auto& a : f.announcers ) {
+                  if( a.key == key ) return; /// announced twice
+               }
+
+               header_fetch::announcer a;
+               a.key = key;
+               a.ses = wp;
+               f.announcers.emplace_back( a );
+
+               if( std::find( f.valid_signatures.begin(), f.valid_signatures.end(), h.producer_signature ) != f.valid_signatures.end() ) {
+                  on_header_verified( id, key, h.producer_signature, true );
+                  return;
+               }
+
+               ++f.verifying;
+               _ioc->post( [this, prev = f.prev, h, id, key]{ /// post this to the thread pool because key recovery can be intensive
+                  bool valid = true;
+                  try {
+                     prev->next( h );
+                  } catch( const fc::exception& e ) {
+                     wlog( "invalid block header announced #${n} ${id}: ${e}", ("n", block_header::num_from_id(id))("id", id)("e", e.to_string()) );
+                     valid = false;
+                  }
+                  app().get_io_service().post( [this, id, key, sig = h.producer_signature, valid]{
+                     auto itr = _header_fetches.find( id );
+                     if( itr == _header_fetches.end() ) return; /// arrived while we were validating
+                     --itr->second.verifying;
+                     on_header_verified( id, key, sig, valid );
+                  });
+               });
+            });
+         }
+
+         /**
+          *  Only the announcer whose header failed validation is disconnected, others may have
+          *  announced the same id with a valid signature.
+          */
+         void on_header_verified( const block_id_type& id, const session* key, const signature_type& sig, bool valid ) {
+            verify_strand_in_this_thread(app().get_io_service().get_executor(), __func__, __LINE__);
+            auto itr = _header_fetches.find( id );
+            if( itr == _header_fetches.end() ) return;
+            auto& f = itr->second;
+
+            auto aitr = std::find_if( f.announcers.begin(), f.announcers.end(), [key]( const auto& a ){ return a.key == key; } );
+            if( aitr == f.announcers.end() ) return;
+
+            if( !valid ) {
+               if( auto ses = aitr->ses.lock() ) {
+                  ses->_ios.post( boost::asio::bind_executor( ses->_strand, [ses]{
+                     ses->do_goodbye( "announced invalid block header" );
+                  }));
+               }
+               f.announcers.erase( aitr );
+            } else {
+               aitr->verified = true;
+               if( std::find( f.valid_signatures.begin(), f.valid_signatures.end(), sig ) == f.valid_signatures.end() )
+                  f.valid_signatures.emplace_back( sig );
+               if( f.requested != fc::time_point() ) return; /// a body request is already out
+               request_block_body( id, f );
+            }
+
+            if( f.requested == fc::time_point() && f.verifying == 0 && f.announcers.empty() )
+               _header_fetches.erase( itr );
+         }
+
+         /**
+          * Requests the body from the first validated announcer not asked yet.
+          * @return false if there is no such announcer
+          */
+         bool request_block_body( const block_id_type& id, header_fetch& f ) {
+            for( auto& a : f.announcers ) {
+               if( !a.verified || a.requested ) continue;
+               a.requested = true;
+               auto ses = a.ses.lock();
+               if( !ses ) continue;
+               f.requested = fc::time_point::now();
+               ses->_ios.post( boost::asio::bind_executor( ses->_strand, [ses, id]{ ses->request_block( id ); } ) );
+               return true;
+            }
+            return false;
+         }
+
+         /**
+          * Requests the body from the next announcer when the previous one did not deliver
+          * in time. Fetches nobody is left to ask are dropped, those blocks arrive through
+          * the regular stream.
+          */
+         void on_header_fetch_timer() {
+            verify_strand_in_this_thread(app().get_io_service().get_executor(), __func__, __LINE__);
+            const auto now = fc::time_point::now();
+            for( auto itr = _header_fetches.begin(); itr != _header_fetches.end(); ) {
+               auto& f = itr->second;
+               if( f.requested != fc::time_point() && now - f.requested > _header_fetch_timeout &&
+                   !request_block_body( itr->first, f ) && f.verifying == 0 ) {
+                  itr = _header_fetches.erase( itr );
+               } else {
+                  ++itr;
+               }
+            }
+
+            start_header_fetch_timer();
+         }
+
+         void start_header_fetch_timer() {
+            _header_fetch_timer->expires_from_now( boost::posix_time::microseconds( _header_fetch_timeout.count() / 2 ) );
+            _header_fetch_timer->async_wait([=](const boost::system::error_code& ec) {
+                if( ec ) { return; }
+                on_header_fetch_timer();
+            });
+         }
+
          void on_reconnect_peers() {
              verify_strand_in_this_thread(app().get_io_service().get_executor(), __func__, __LINE__);
              for( const auto& peer : _connect_to_peers ) {
@@ -1301,6 +1636,8 @@ namespace snax {
          ("bnet-threads", bpo::value<uint32_t>(), "the number of threads to use to process network messages" )
          ("bnet-connect", bpo::value<vector<string>>()->composing(), "remote endpoint of other node to connect to; Use multiple bnet-connect options as needed to compose a network" )
          ("bnet-no-trx", bpo::bool_switch()->default_value(false), "this peer will request no pending transactions from other nodes" )
+         ("bnet-header-first", bpo::value<bool>()->default_value(false), "this peer will request new block headers as soon as other nodes accept them, validate them in parallel and fetch the blocks from the first node to announce them" )
+         ("bnet-header-fetch-timeout-ms", bpo::value<uint32_t>()->default_value(500), "time to wait for a block requested in header-first mode before requesting it from the next node that announced it" )
          ("bnet-peer-log-format", bpo::value<string>()->default_value( "[\"${_name}\" ${_ip}:${_port}]" ),
            "The string used to format peers when logging messages about them.  Variables are escaped with ${<variable name>}.\n"
            "Available Variables:\n"
@@ -1332,6 +1669,12 @@ namespace snax {
          if( options.count( "bnet-follow-irreversible" )) {
             my->_follow_irreversible = options.at( "bnet-follow-irreversible" ).as<bool>();
          }
+         my->_header_first = options.at( "bnet-header-first" ).as<bool>();
+         if( my->_header_first && my->_follow_irreversible ) {
+            my->_header_first = false;
+            ilog( "disabled bnet-header-first since bnet-follow-irreversible only requests irreversible blocks" );
+         }
+         my->_header_fetch_timeout = fc::milliseconds( std::max<uint32_t>( options.at( "bnet-header-fetch-timeout-ms" ).as<uint32_t>(), 10 ) );
 
 
          if( options.count( "bnet-connect" )) {
@@ -1398,6 +1741,11 @@ namespace snax {
 
       my->start_reconnect_timer();
 
+      if( my->_header_first ) {
+         my->_header_fetch_timer = std::make_shared<boost::asio::deadline_timer>( app().get_io_service() );
+         my->start_header_fetch_timer();
+      }
+
       my->_listener = std::make_shared<listener>( ioc,
                                                   tcp::endpoint{ address, my->_bnet_endpoint_port },
                                                   my );
@@ -1420,6 +1768,10 @@ namespace snax {
       try {
          my->_timer->cancel();
          my->_timer.reset();
+         if( my->_header_fetch_timer ) {
+            my->_header_fetch_timer->cancel();
+            my->_header_fetch_timer.reset();
+         }
       } catch ( ... ) {
          elog( "exception thrown on timer shutdown" );
       }
@@ -1467,8 +1819,15 @@ namespace snax {
           hello_msg.chain_id = app().get_plugin<chain_plugin>().get_chain_id(); // TODO: Quick fix in a rush. Maybe a better solution is needed.
 
           self->_local_lib = lib;
+          vector<hello_extension> exs;
           if ( self->_net_plugin->_follow_irreversible ) {
-             self->send( hello_msg, hello_extension(hello_extension_irreversible_only()) );
+             exs.emplace_back( hello_extension_irreversible_only() );
+          }
+          if ( self->_net_plugin->_header_first ) {
+             exs.emplace_back( hello_extension_header_first() );
+          }
+          if ( exs.size() ) {
+             self->send( hello_msg, exs );
           } else {
              self->send( hello_msg );
           }
@@ -1518,6 +1877,8 @@ namespace snax {
                fc::raw::unpack( dsx, ex );
                if ( ex.which() == hello_extension::tag<hello_extension_irreversible_only>::value ) {
                   _remote_request_irreversible_only = true;
+               } else if ( ex.which() == hello_extension::tag<hello_extension_header_first>::value ) {
+                  _remote_header_first = true;
                }
             } else {
                //unsupported extension, we just ignore it
@@ -1540,6 +1901,17 @@ namespace snax {
 
    }
 
+   void session::on( const block_header_announce& announce ) {
+      peer_ilog(this, "received block_header_announce");
+      for( const auto& h : announce.headers ) {
+         auto id = h.id();
+         status( "received header " + std::to_string( block_header::num_from_id(id) ) );
+         mark_block_status( id, true, false );
+         if( _net_plugin->_header_first )
+            _net_plugin->on_header_announce( shared_from_this(), h, id );
+      }
+   }
+
    void session::on( const packed_transaction_ptr& p ) {
       peer_ilog(this, "received packed_transaction_ptr");
       if (!p) {
@@ -4,6 +4,7 @@
  */
 #include <snax/chain_api_plugin/chain_api_plugin.hpp>
 #include <snax/chain/exceptions.hpp>
+#include <snax/chain/controller_metrics.hpp>
 
 #include <fc/io/json.hpp>
 
@@ -102,11 +103,26 @@ void chain_api_plugin::plugin_startup() {
       CHAIN_RO_CALL(abi_json_to_bin, 200),
       CHAIN_RO_CALL(abi_bin_to_json, 200),
       CHAIN_RO_CALL(get_required_keys, 200),
+      CHAIN_RO_CALL(get_required_keys_batch, 200),
       CHAIN_RO_CALL(get_transaction_id, 200),
+      CHAIN_RO_CALL(get_cache_stats, 200),
+      CHAIN_RO_CALL(get_controller_metrics, 200),
       CHAIN_RW_CALL_ASYNC(push_block, chain_apis::read_write::push_block_results, 202),
       CHAIN_RW_CALL_ASYNC(push_transaction, chain_apis::read_write::push_transaction_results, 202),
       CHAIN_RW_CALL_ASYNC(push_transactions, chain_apis::read_write::push_transactions_results, 202)
    });
+
+   // same data as get_controller_metrics, in the Prometheus text format so it can be scraped directly
+   _http_plugin.add_api({
+      {std::string("/v1/chain/metrics"),
+         [this](string, string body, url_response_callback cb) {
+            try {
+               cb(200, my->db.get_metrics().to_prometheus());
+            } catch (...) {
+               http_plugin::handle_exception("chain", "metrics", body, cb);
+            }
+         }}
+   });
 }
 
 void chain_api_plugin::plugin_shutdown() {}
@@ -220,6 +220,10 @@ void chain_plugin::set_program_options(options_description& cli, options_descrip
          ("reversible-blocks-db-guard-size-mb", bpo::value<uint64_t>()->default_value(config::default_reversible_guard_size / (1024  * 1024)), "Safely shut down node when free space remaining in the reverseible blocks database drops below this size (in MiB).")
          ("chain-threads", bpo::value<uint16_t>()->default_value(config::default_controller_thread_pool_size),
           "Number of worker threads in controller thread pool")
+         ("signature-cache-size", bpo::value<uint32_t>()->default_value(config::default_sig_cache_size),
+          "Maximum number of recovered signature keys cached across all threads")
+         ("authority-cache-size", bpo::value<uint32_t>()->default_value(config::default_auth_cache_size),
+          "Maximum number of satisfied authority checks cached, 0 to disable")
          ("contracts-console", bpo::bool_switch()->default_value(false),
           "print contract's output to console")
          ("actor-whitelist", boost::program_options::value<vector<string>>()->composing()->multitoken(),
@@ -426,6 +430,12 @@ void chain_plugin::plugin_initialize(const variables_map& options) {
                      "chain-threads ${num} must be greater than 0", ("num", my->chain_config->thread_pool_size) );
       }
 
+      if( options.count( "signature-cache-size" ))
+         my->chain_config->sig_cache_size = options.at( "signature-cache-size" ).as<uint32_t>();
+
+      if( options.count( "authority-cache-size" ))
+         my->chain_config->auth_cache_size = options.at( "authority-cache-size" ).as<uint32_t>();
+
       if( my->wasm_runtime )
          my->chain_config->wasm_runtime = *my->wasm_runtime;
 
@@ -759,6 +769,10 @@ void chain_plugin::accept_transaction(const chain::packed_transaction& trx, next
    my->incoming_transaction_async_method(std::make_shared<packed_transaction>(trx), false, std::forward<decltype(next)>(next));
 }
 
+void chain_plugin::accept_transaction(const chain::packed_transaction_ptr& trx, next_function<chain::transaction_trace_ptr> next) {
+   my->incoming_transaction_async_method(trx, false, std::forward<decltype(next)>(next));
+}
+
 bool chain_plugin::block_is_on_preferred_chain(const block_id_type& block_id) {
    auto b = chain().fetch_block_by_number( block_header::num_from_id(block_id) );
    return b && b->id() == block_id;
@@ -1850,10 +1864,31 @@ read_only::get_required_keys_result read_only::get_required_keys( const get_requ
    return result;
 }
 
+read_only::get_required_keys_batch_results read_only::get_required_keys_batch( const get_required_keys_batch_params& params )const {
+   SNAX_ASSERT( params.size() <= 1000, too_many_tx_at_once, "Attempt to resolve keys of too many transactions at once" );
+   get_required_keys_batch_results results;
+   results.reserve( params.size() );
+   for( size_t i = 0; i < params.size(); ++i ) {
+      try {
+         results.emplace_back( get_required_keys( params[i] ) );
+      } FC_CAPTURE_AND_RETHROW( (i) )
+   }
+   return results;
+}
+
 read_only::get_transaction_id_result read_only::get_transaction_id( const read_only::get_transaction_id_params& params)const {
    return params.id();
 }
 
+read_only::get_cache_stats_results read_only::get_cache_stats( const read_only::get_cache_stats_params& )const {
+   const auto& authm = db.get_authorization_manager();
+   return { signature_recovery_cache::instance().get_stats(), authm.get_cache_stats(), authm.get_required_keys_cache_stats() };
+}
+
+read_only::get_controller_metrics_results read_only::get_controller_metrics( const read_only::get_controller_metrics_params& )const {
+   return db.get_metrics().get_snapshot();
+}
+
 namespace detail {
    struct ram_market_exchange_state_t {
       asset  ignore1;
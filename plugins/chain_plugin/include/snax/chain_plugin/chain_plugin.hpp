@@ -12,6 +12,9 @@
 #include <snax/chain/contract_table_objects.hpp>
 #include <snax/chain/resource_limits.hpp>
 #include <snax/chain/transaction.hpp>
+#include <snax/chain/signature_recovery_cache.hpp>
+#include <snax/chain/authorization_manager.hpp>
+#include <snax/chain/controller_metrics.hpp>
 #include <snax/chain/abi_serializer.hpp>
 #include <snax/chain/plugin_interface.hpp>
 #include <snax/chain/types.hpp>
@@ -243,11 +246,31 @@ public:
 
    get_required_keys_result get_required_keys( const get_required_keys_params& params)const;
 
+   using get_required_keys_batch_params  = vector<get_required_keys_params>;
+   using get_required_keys_batch_results = vector<get_required_keys_result>;
+
+   get_required_keys_batch_results get_required_keys_batch( const get_required_keys_batch_params& params )const;
+
    using get_transaction_id_params = transaction;
    using get_transaction_id_result = transaction_id_type;
 
    get_transaction_id_result get_transaction_id( const get_transaction_id_params& params)const;
 
+   using get_cache_stats_params = empty;
+
+   struct get_cache_stats_results {
+      chain::signature_recovery_cache::stats        signature_recovery;
+      chain::authorization_manager::cache_stats     authorization;
+      chain::authorization_manager::cache_stats     required_keys;
+   };
+
+   get_cache_stats_results get_cache_stats( const get_cache_stats_params& params )const;
+
+   using get_controller_metrics_params = empty;
+   using get_controller_metrics_results = chain::controller_metrics::snapshot;
+
+   get_controller_metrics_results get_controller_metrics( const get_controller_metrics_params& params )const;
+
    struct get_block_params {
       string block_num_or_id;
    };
@@ -664,6 +687,7 @@ public:
 
    void accept_block( const chain::signed_block_ptr& block );
    void accept_transaction(const chain::packed_transaction& trx, chain::plugin_interface::next_function<chain::transaction_trace_ptr> next);
+   void accept_transaction(const chain::packed_transaction_ptr& trx, chain::plugin_interface::next_function<chain::transaction_trace_ptr> next);
 
    bool block_is_on_preferred_chain(const chain::block_id_type& block_id);
 
@@ -752,3 +776,4 @@ FC_REFLECT( snax::chain_apis::read_only::abi_bin_to_json_params, (code)(action)(
 FC_REFLECT( snax::chain_apis::read_only::abi_bin_to_json_result, (args) )
 FC_REFLECT( snax::chain_apis::read_only::get_required_keys_params, (transaction)(available_keys) )
 FC_REFLECT( snax::chain_apis::read_only::get_required_keys_result, (required_keys) )
+FC_REFLECT( snax::chain_apis::read_only::get_cache_stats_results, (signature_recovery)(authorization)(required_keys) )
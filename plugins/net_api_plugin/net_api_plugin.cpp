@@ -77,6 +77,8 @@ void net_api_plugin::plugin_startup() {
             INVOKE_R_R(net_mgr, status, std::string), 201),
        CALL(net, net_mgr, connections,
             INVOKE_R_V(net_mgr, connections), 201),
+       CALL(net, net_mgr, telemetry,
+            INVOKE_R_V(net_mgr, telemetry), 201),
     //   CALL(net, net_mgr, open,
     //        INVOKE_V_R(net_mgr, open, std::string), 200),
    });
@@ -10,11 +10,81 @@
 namespace snax {
    using namespace appbase;
 
+   struct compression_stats {
+      uint64_t          messages_sent = 0;                ///< sent compressed
+      uint64_t          bytes_sent = 0;                   ///< of compressed messages, as sent
+      uint64_t          uncompressed_bytes_sent = 0;      ///< of compressed messages, before compression
+      uint64_t          compress_time_us = 0;             ///< a broadcast compressed once is charged to the first peer
+      uint64_t          messages_received = 0;
+      uint64_t          bytes_received = 0;
+      uint64_t          uncompressed_bytes_received = 0;
+      uint64_t          decompress_time_us = 0;
+   };
+
    struct connection_status {
       string            peer;
       bool              connecting = false;
       bool              syncing    = false;
       handshake_message last_handshake;
+      compression_stats compression;
+   };
+
+   /// traffic of one net_message type with a peer, counted as framed on the wire
+   struct message_type_stats {
+      string            type;
+      uint64_t          messages_sent = 0;                ///< queued for sending
+      uint64_t          bytes_sent = 0;
+      uint64_t          messages_received = 0;
+      uint64_t          bytes_received = 0;
+   };
+
+   struct peer_telemetry {
+      string                      peer;
+      bool                        connecting = false;
+      bool                        syncing    = false;
+      uint32_t                    head_num = 0;                    ///< as last reported by the peer
+      uint32_t                    last_irreversible_block_num = 0;
+      vector<message_type_stats>  messages;                        ///< types never exchanged with the peer are left out
+      uint32_t                    write_queue_bytes = 0;           ///< queued and not handed to the socket yet
+      uint32_t                    write_queue_messages = 0;
+      uint32_t                    sync_write_queue_messages = 0;
+      uint32_t                    out_queue_messages = 0;          ///< being written to the socket
+      uint64_t                    blocks_received = 0;
+      uint64_t                    duplicate_blocks_received = 0;   ///< already known when they arrived
+      uint64_t                    trxs_received = 0;
+      uint64_t                    duplicate_trxs_received = 0;
+      uint64_t                    block_latency_samples = 0;       ///< new blocks received from the peer while in sync
+      int64_t                     avg_block_latency_us = 0;        ///< arrival relative to the block timestamp
+      int64_t                     max_block_latency_us = 0;
+      uint32_t                    sync_range_start = 0;            ///< blocks being fetched from the peer, 0 for none
+      uint32_t                    sync_range_end = 0;
+      uint32_t                    sync_range_last_received = 0;
+      uint32_t                    sync_span = 0;                   ///< blocks per range requested from the peer
+   };
+
+   /// delay of the blocks of a producer to reach us, from the first peer that delivered each
+   struct producer_propagation {
+      chain::account_name  producer;
+      uint64_t             blocks = 0;
+      int64_t              avg_delay_us = 0;
+      int64_t              max_delay_us = 0;
+      int64_t              last_delay_us = 0;
+   };
+
+   struct sync_progress {
+      string            state;
+      uint32_t          known_lib_num = 0;
+      uint32_t          next_expected_num = 0;
+      uint32_t          last_requested_num = 0;
+      uint32_t          ranges_in_flight = 0;
+      uint32_t          unassigned_ranges = 0;
+      uint32_t          buffered_blocks = 0;              ///< received ahead of next_expected_num
+   };
+
+   struct network_telemetry {
+      vector<peer_telemetry>        peers;
+      vector<producer_propagation>  producers;
+      sync_progress                 sync;
    };
 
    class net_plugin : public appbase::plugin<net_plugin>
@@ -36,6 +106,7 @@ namespace snax {
         string                       disconnect( const string& endpoint );
         optional<connection_status>  status( const string& endpoint )const;
         vector<connection_status>    connections()const;
+        network_telemetry            telemetry()const;
 
         size_t num_peers() const;
       private:
@@ -44,4 +115,18 @@ namespace snax {
 
 }
 
-FC_REFLECT( snax::connection_status, (peer)(connecting)(syncing)(last_handshake) )
+FC_REFLECT( snax::compression_stats,
+            (messages_sent)(bytes_sent)(uncompressed_bytes_sent)(compress_time_us)
+            (messages_received)(bytes_received)(uncompressed_bytes_received)(decompress_time_us) )
+FC_REFLECT( snax::connection_status, (peer)(connecting)(syncing)(last_handshake)(compression) )
+FC_REFLECT( snax::message_type_stats, (type)(messages_sent)(bytes_sent)(messages_received)(bytes_received) )
+FC_REFLECT( snax::peer_telemetry,
+            (peer)(connecting)(syncing)(head_num)(last_irreversible_block_num)(messages)
+            (write_queue_bytes)(write_queue_messages)(sync_write_queue_messages)(out_queue_messages)
+            (blocks_received)(duplicate_blocks_received)(trxs_received)(duplicate_trxs_received)
+            (block_latency_samples)(avg_block_latency_us)(max_block_latency_us)
+            (sync_range_start)(sync_range_end)(sync_range_last_received)(sync_span) )
+FC_REFLECT( snax::producer_propagation, (producer)(blocks)(avg_delay_us)(max_delay_us)(last_delay_us) )
+FC_REFLECT( snax::sync_progress,
+            (state)(known_lib_num)(next_expected_num)(last_requested_num)(ranges_in_flight)(unassigned_ranges)(buffered_blocks) )
+FC_REFLECT( snax::network_telemetry, (peers)(producers)(sync) )
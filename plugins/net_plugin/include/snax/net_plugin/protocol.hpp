@@ -132,6 +132,40 @@ namespace snax {
       uint32_t end_block;
    };
 
+   /**
+    *  A block relayed without the packed transactions the receiver most likely has already. The receipts
+    *  at the indexes in elided carry the id of their packed_transaction instead of the transaction itself.
+    *  Only sent to peers at proto_compact_blocks or later.
+    */
+   struct compact_block_message {
+      signed_block_header           header;
+      vector<transaction_receipt>   transactions;
+      extensions_type               block_extensions;
+      vector<uint32_t>              elided;
+   };
+
+   /// asks the sender of a compact block for the elided transactions the receiver does not have
+   struct get_block_transactions_message {
+      block_id_type      block_id;
+      vector<uint32_t>   indexes;
+   };
+
+   struct block_transactions_message {
+      block_id_type                block_id;
+      vector<packed_transaction>   transactions; ///< in the order of get_block_transactions_message::indexes
+   };
+
+   /// a packed net_message compressed with zlib, only sent to peers at proto_compression or later
+   struct compressed_message {
+      uint32_t   uncompressed_size = 0;
+      bytes      data;
+   };
+
+   /// transactions relayed to a peer within a short window, sent as one message
+   struct transaction_batch_message {
+      vector<packed_transaction> transactions;
+   };
+
    using net_message = static_variant<handshake_message,
                                       chain_size_message,
                                       go_away_message,
@@ -140,7 +174,12 @@ namespace snax {
                                       request_message,
                                       sync_request_message,
                                       signed_block,
-                                      packed_transaction>;
+                                      packed_transaction,
+                                      compact_block_message,
+                                      get_block_transactions_message,
+                                      block_transactions_message,
+                                      compressed_message,
+                                      transaction_batch_message>;
 
 } // namespace snax
 
@@ -159,6 +198,11 @@ FC_REFLECT( snax::time_message, (org)(rec)(xmt)(dst) )
 FC_REFLECT( snax::notice_message, (known_trx)(known_blocks) )
 FC_REFLECT( snax::request_message, (req_trx)(req_blocks) )
 FC_REFLECT( snax::sync_request_message, (start_block)(end_block) )
+FC_REFLECT( snax::compact_block_message, (header)(transactions)(block_extensions)(elided) )
+FC_REFLECT( snax::get_block_transactions_message, (block_id)(indexes) )
+FC_REFLECT( snax::block_transactions_message, (block_id)(transactions) )
+FC_REFLECT( snax::compressed_message, (uncompressed_size)(data) )
+FC_REFLECT( snax::transaction_batch_message, (transactions) )
 
 /**
  *
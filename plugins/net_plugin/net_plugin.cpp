@@ -12,6 +12,7 @@
 #include <snax/chain/plugin_interface.hpp>
 #include <snax/producer_plugin/producer_plugin.hpp>
 #include <snax/chain/contract_types.hpp>
+#include <snax/chain/merkle.hpp>
 
 #include <fc/network/message_buffer.hpp>
 #include <fc/network/ip.hpp>
@@ -21,11 +22,18 @@
 #include <fc/container/flat.hpp>
 #include <fc/reflect/variant.hpp>
 #include <fc/crypto/rand.hpp>
+#include <fc/bitutil.hpp>
+#include <fc/scoped_exit.hpp>
 #include <fc/exception/exception.hpp>
 
 #include <boost/asio/ip/tcp.hpp>
 #include <boost/asio/ip/host_name.hpp>
 #include <boost/asio/steady_timer.hpp>
+#include <boost/asio/strand.hpp>
+#include <boost/asio/thread_pool.hpp>
+#include <boost/iostreams/filtering_stream.hpp>
+#include <boost/iostreams/device/back_inserter.hpp>
+#include <boost/iostreams/filter/zlib.hpp>
 #include <boost/intrusive/set.hpp>
 
 using namespace snax::chain::plugin_interface::compat;
@@ -62,13 +70,21 @@ namespace snax {
 
    using net_message_ptr = shared_ptr<net_message>;
 
+   /// a framed message (size prefix + packed net_message), shared by every connection it is queued on
+   using send_buffer_ptr = std::shared_ptr<const vector<char>>;
+
+   /// a signed_block message as it was received, relayed to peers without packing the block again
+   struct received_block_bytes {
+      block_id_type    id;     ///< hashed from the received header bytes
+      send_buffer_ptr  bytes;
+   };
+
    struct node_transaction_state {
       transaction_id_type id;
       time_point_sec  expires;  /// time after which this may be purged.
                                 /// Expires increased while the txn is
                                 /// "in flight" to anoher peer
-      packed_transaction packed_txn;
-      vector<char>    serialized_txn; /// the received raw bundle
+      send_buffer_ptr serialized_txn; /// the framed trx message, the only copy of the trx kept here
       uint32_t        block_num = 0; /// block transaction was included in
       uint32_t        true_block = 0; /// used to reset block_uum when request is 0
       uint16_t        requests = 0; /// the number of "in flight" requests for this txn
@@ -149,6 +165,9 @@ namespace snax {
       unique_ptr<boost::asio::steady_timer> connector_check;
       unique_ptr<boost::asio::steady_timer> transaction_check;
       unique_ptr<boost::asio::steady_timer> keepalive_timer;
+      unique_ptr<boost::asio::steady_timer> trx_batch_timer;
+      bool                                  trx_batch_timer_armed = false;
+      boost::asio::steady_timer::duration   trx_batch_window;
       boost::asio::steady_timer::duration   connector_period;
       boost::asio::steady_timer::duration   txn_exp_period;
       boost::asio::steady_timer::duration   resp_expected_period;
@@ -166,10 +185,17 @@ namespace snax {
       int                           started_sessions = 0;
 
       node_transaction_index        local_txns;
+      std::map<block_id_type, send_buffer_ptr> received_block_buffers; ///< blocks being accepted, see process_block
+      std::map<chain::account_name, producer_propagation> propagation; ///< by producer, of blocks first received while in sync
 
       shared_ptr<tcp::resolver>     resolver;
 
       bool                          use_socket_read_watermark = false;
+      bool                          compact_blocks = true;
+      bool                          compression = false;
+
+      uint16_t                                 decode_threads = def_net_decode_threads;
+      optional<boost::asio::thread_pool>       decode_pool; ///< decodes received messages off the main thread, see connection::queue_decode
 
       channels::transaction_ack::channel_type::handle  incoming_transaction_ack_subscription;
 
@@ -184,6 +210,8 @@ namespace snax {
 
       template<typename VerifierFunc>
       void send_all( const net_message &msg, VerifierFunc verify );
+      template<typename VerifierFunc>
+      void send_all( const send_buffer_ptr& send_buffer, VerifierFunc verify );
 
       void accepted_block_header(const block_state_ptr&);
       void accepted_block(const block_state_ptr&);
@@ -217,11 +245,24 @@ namespace snax {
       void handle_message( connection_ptr c, const notice_message &msg);
       void handle_message( connection_ptr c, const request_message &msg);
       void handle_message( connection_ptr c, const sync_request_message &msg);
-      void handle_message( connection_ptr c, const signed_block &msg);
+      void handle_message( connection_ptr c, const signed_block &msg, const received_block_bytes* raw = nullptr );
+      void process_block( connection_ptr c, const signed_block &msg, const received_block_bytes* raw = nullptr );
       void handle_message( connection_ptr c, const packed_transaction &msg);
+      void handle_message( connection_ptr c, const compact_block_message &msg);
+      void handle_message( connection_ptr c, const get_block_transactions_message &msg);
+      void handle_message( connection_ptr c, const block_transactions_message &msg);
+      void handle_message( connection_ptr c, const compressed_message &msg);
+      void handle_message( connection_ptr c, const transaction_batch_message &msg);
+
+      optional<compact_block_message> make_compact_block( const signed_block& b, const connection& c );
+      /// hands a block rebuilt from a compact block to the chain, falls back to the elided transactions on a merkle mismatch
+      void accept_compact_block( connection_ptr c, const signed_block_ptr& b, const vector<uint32_t>& elided, bool all_from_peer );
+      void request_compact_block_transactions( connection_ptr c, const block_id_type& id,
+                                               const signed_block_ptr& b, const vector<uint32_t>& elided, vector<uint32_t> missing );
 
       void start_conn_timer(boost::asio::steady_timer::duration du, std::weak_ptr<connection> from_connection);
       void start_txn_timer( );
+      void start_trx_batch_timer( );
       void start_monitors( );
 
       void expire_txns( );
@@ -308,13 +349,23 @@ namespace snax {
    constexpr boost::asio::chrono::milliseconds def_read_delay_for_full_write_queue{100};
    constexpr auto     def_max_reads_in_flight = 1000;
    constexpr auto     def_max_trx_in_progress_size = 100*1024*1024; // 100 MB
+   constexpr auto     def_max_decode_in_progress_size = def_send_buffer_size*10;
+   constexpr uint16_t def_net_decode_threads = 2;
+   constexpr uint32_t def_min_compress_size = 1024; ///< smaller messages are always sent uncompressed
    constexpr auto     def_max_clients = 25; // 0 for unlimited clients
    constexpr auto     def_max_nodes_per_host = 1;
    constexpr auto     def_conn_retry_wait = 30;
    constexpr auto     def_txn_expire_wait = std::chrono::seconds(3);
    constexpr auto     def_resp_expected_wait = std::chrono::seconds(5);
    constexpr auto     def_sync_fetch_span = 100;
+   constexpr auto     def_sync_fetch_peers = 3;
+   constexpr auto     def_trx_batch_window_ms = 10;
+   constexpr auto     def_trx_batch_size = 64*1024; // bytes of relayed transactions that flush a batch before its window ends
+   constexpr auto     def_known_trx_capacity = 100000; // per generation of a known_trx_filter, about 180KiB
+   constexpr auto     def_known_trx_rotation_sec = 60;
+   constexpr auto     def_sync_range_target_time = std::chrono::seconds(2); // time a sync range should take a peer to deliver
    constexpr uint32_t  def_max_just_send = 1500; // roughly 1 "mtu"
+   constexpr auto     def_max_pending_compact_blocks = 8; // per peer, waiting for their elided transactions
    constexpr bool     large_msg_notify = false;
 
    constexpr auto     message_header_size = 4;
@@ -339,46 +390,83 @@ namespace snax {
     */
    constexpr uint16_t proto_base = 0;
    constexpr uint16_t proto_explicit_sync = 1;
+   constexpr uint16_t proto_compact_blocks = 2;   ///< compact_block_message and the block transaction messages
+   constexpr uint16_t proto_compression = 3;      ///< compressed_message
+   constexpr uint16_t proto_trx_batch = 4;        ///< transaction_batch_message
 
-   constexpr uint16_t net_version = proto_explicit_sync;
+   constexpr uint16_t net_version = proto_trx_batch;
 
    /**
-    *  Index by id
-    *  Index by is_known, block_num, validated_time, this is the order we will broadcast
-    *  to peer.
-    *  Index by is_noticed, validated_time
+    *  Ids of the transactions a peer knows, because we sent them to it or it told us about them.
     *
+    *  Kept in two generations of a bloom filter. Inserts go to the current generation, which replaces the
+    *  previous one once it holds def_known_trx_capacity ids or is older than def_known_trx_rotation_sec, so an id
+    *  is remembered for at least one full generation and memory stays bounded. Ids are sha256 digests, their words
+    *  serve as the hashes. A false positive, about 0.1%, only means a transaction is not relayed to this peer by us.
     */
-   struct transaction_state {
-      transaction_id_type id;
-      bool                is_known_by_peer = false; ///< true if we sent or received this trx to this peer or received notice from peer
-      bool                is_noticed_to_peer = false; ///< have we sent peer notice we know it (true if we receive from this peer)
-      uint32_t            block_num = 0; ///< the block number the transaction was included in
-      time_point_sec      expires;
-      time_point          requested_time; /// in case we fetch large trx
-   };
+   class known_trx_filter {
+   public:
+      known_trx_filter()
+      :_current( def_known_trx_capacity * bits_per_id ),_previous( def_known_trx_capacity * bits_per_id ) {}
+
+      void insert( const transaction_id_type& id ) {
+         auto now = fc::time_point::now();
+         if( _current.size >= def_known_trx_capacity || now - _current.started >= fc::seconds( def_known_trx_rotation_sec ) ) {
+            std::swap( _current, _previous );
+            _current.reset( now );
+         }
+         const uint64_t nbits = _current.bits.size() * 64;
+         for( uint64_t i = 0, h = id._hash[0]; i < hash_count; ++i, h += id._hash[1] | 1 ) {
+            _current.bits[(h % nbits) / 64] |= uint64_t(1) << (h % 64);
+         }
+         ++_current.size;
+      }
 
-   struct update_txn_expiry {
-      time_point_sec new_expiry;
-      update_txn_expiry(time_point_sec e) : new_expiry(e) {}
-      void operator() (transaction_state& ts) {
-         ts.expires = new_expiry;
+      bool contains( const transaction_id_type& id )const {
+         return _current.contains( id ) || _previous.contains( id );
       }
-   };
 
-   typedef multi_index_container<
-      transaction_state,
-      indexed_by<
-         ordered_unique< tag<by_id>, member<transaction_state, transaction_id_type, &transaction_state::id > >,
-         ordered_non_unique< tag< by_expiry >, member< transaction_state,fc::time_point_sec,&transaction_state::expires >>,
-         ordered_non_unique<
-            tag<by_block_num>,
-            member< transaction_state,
-                    uint32_t,
-                    &transaction_state::block_num > >
-         >
+      void clear() {
+         _current.reset( fc::time_point::now() );
+         _previous.reset( fc::time_point::now() );
+      }
 
-      > transaction_state_index;
+   private:
+      static constexpr uint32_t hash_count = 10;
+      static constexpr uint32_t bits_per_id = 15;
+
+      struct generation {
+         explicit generation( uint32_t nbits ) : bits( (nbits + 63) / 64 ) {}
+
+         bool contains( const transaction_id_type& id )const {
+            if( size == 0 ) {
+               return false;
+            }
+            const uint64_t nbits = bits.size() * 64;
+            for( uint64_t i = 0, h = id._hash[0]; i < hash_count; ++i, h += id._hash[1] | 1 ) {
+               if( !(bits[(h % nbits) / 64] & (uint64_t(1) << (h % 64))) ) {
+                  return false;
+               }
+            }
+            return true;
+         }
+
+         void reset( fc::time_point now ) {
+            if( size != 0 ) {
+               std::fill( bits.begin(), bits.end(), 0 );
+            }
+            size = 0;
+            started = now;
+         }
+
+         vector<uint64_t> bits;
+         uint32_t         size = 0;
+         fc::time_point   started = fc::time_point::now();
+      };
+
+      generation _current;
+      generation _previous;
+   };
 
    /**
     *
@@ -392,9 +480,6 @@ namespace snax {
    };
 
    struct update_request_time {
-      void operator() (struct transaction_state &ts) {
-         ts.requested_time = time_point::now();
-      }
       void operator () (struct snax::peer_block_state &bs) {
          bs.requested_time = time_point::now();
       }
@@ -413,9 +498,6 @@ namespace snax {
       void operator() (snax::peer_block_state& bs) {
          bs.is_known = true;
       }
-      void operator() (transaction_state& ts) {
-         ts.is_known_by_peer = true;
-      }
    } set_is_known;
 
 
@@ -430,9 +512,6 @@ namespace snax {
             nts.block_num = new_bnum;
          }
       }
-      void operator() (transaction_state& ts) {
-         ts.block_num = new_bnum;
-      }
       void operator() (peer_block_state& pbs) {
          pbs.block_num = new_bnum;
       }
@@ -471,6 +550,9 @@ namespace snax {
       }
 
       uint32_t write_queue_size() const { return _write_queue_size; }
+      uint32_t write_queue_count() const { return _write_queue.size(); }
+      uint32_t sync_write_queue_count() const { return _sync_write_queue.size(); }
+      uint32_t out_queue_count() const { return _out_queue.size(); }
 
       bool is_out_queue_empty() const { return _out_queue.empty(); }
 
@@ -479,7 +561,7 @@ namespace snax {
          return ((!_sync_write_queue.empty() || !_write_queue.empty()) && _out_queue.empty());
       }
 
-      bool add_write_queue( const std::shared_ptr<vector<char>>& buff,
+      bool add_write_queue( const send_buffer_ptr& buff,
                             std::function<void( boost::system::error_code, std::size_t )> callback,
                             bool to_sync_queue ) {
          if( to_sync_queue ) {
@@ -524,7 +606,7 @@ namespace snax {
 
    private:
       struct queued_write {
-         std::shared_ptr<vector<char>> buff;
+         send_buffer_ptr buff;
          std::function<void( boost::system::error_code, std::size_t )> callback;
       };
 
@@ -545,19 +627,48 @@ namespace snax {
       void initialize();
 
       peer_block_state_index  blk_state;
-      transaction_state_index trx_state;
+      known_trx_filter        known_trxs;
       optional<sync_state>    peer_requested;  // this peer is requesting info from us
       socket_ptr              socket;
 
       fc::message_buffer<1024*1024>    pending_message_buffer;
       fc::optional<std::size_t>        outstanding_read_bytes;
-      vector<char>            blk_buffer;
 
 
       queued_buffer           buffer_queue;
 
       uint32_t                reads_in_flight = 0;
+      /// a block rebuilt from a compact block, waiting for block_transactions_message
+      struct pending_compact_block {
+         signed_block_ptr     block;
+         vector<uint32_t>     elided;    ///< indexes of the receipts elided from the compact block
+         vector<uint32_t>     missing;   ///< indexes of the receipts requested from the peer
+      };
+      std::map<block_id_type, pending_compact_block> pending_compact_blocks;
       uint32_t                trx_in_progress_size = 0;
+      vector<send_buffer_ptr> trx_batch;               ///< packed_transaction messages waiting for the batch to be flushed
+      size_t                  trx_batch_size = 0;
+      uint32_t                decode_in_progress_size = 0; ///< bytes handed to the net thread pool and not yet handled
+      uint32_t                session_id = 0; ///< bumped on close, messages decoded for an earlier session are dropped
+      compression_stats       compression;
+
+      /// traffic of one net_message type, see net_plugin::telemetry
+      struct traffic_counters {
+         uint64_t messages_sent = 0;
+         uint64_t bytes_sent = 0;
+         uint64_t messages_received = 0;
+         uint64_t bytes_received = 0;
+      };
+      vector<traffic_counters> traffic;  ///< by net_message tag
+      uint64_t                blocks_received = 0;
+      uint64_t                duplicate_blocks_received = 0;
+      uint64_t                trxs_received = 0;
+      uint64_t                duplicate_trxs_received = 0;
+      uint64_t                block_latency_samples = 0;
+      int64_t                 block_latency_sum_us = 0;
+      int64_t                 max_block_latency_us = 0;
+
+      optional<boost::asio::strand<boost::asio::thread_pool::executor_type>> decode_strand;
       fc::sha256              node_id;
       handshake_message       last_handshake_recv;
       handshake_message       last_handshake_sent;
@@ -580,9 +691,28 @@ namespace snax {
          stat.connecting = connecting;
          stat.syncing = syncing;
          stat.last_handshake = last_handshake_recv;
+         stat.compression = compression;
          return stat;
       }
 
+      /// counts a framed message of net_message type which, received ones once they unpacked
+      void count_traffic( uint32_t which, size_t bytes, bool sent ) {
+         if( which >= uint32_t(net_message::count()) )
+            return;
+         if( which >= traffic.size() )
+            traffic.resize( which + 1 );
+         auto& t = traffic[which];
+         if( sent ) {
+            ++t.messages_sent;
+            t.bytes_sent += bytes;
+         } else {
+            ++t.messages_received;
+            t.bytes_received += bytes;
+         }
+      }
+
+      peer_telemetry get_telemetry()const;
+
       /** \name Peer Timestamps
        *  Time message handling
        *  @{
@@ -642,6 +772,14 @@ namespace snax {
       void stop_send();
 
       void enqueue( const net_message &msg, bool trigger_send = true, bool to_sync_queue = false );
+      void enqueue_buffer( const send_buffer_ptr& send_buffer, bool trigger_send, bool to_sync_queue,
+                           go_away_reason close_after_send );
+      /// whether messages to this peer may be sent as compressed_message
+      bool compression_enabled()const;
+      /// whether relayed transactions are sent to this peer as transaction_batch_message
+      bool trx_batching_enabled()const;
+      void add_to_trx_batch( const send_buffer_ptr& trx_buffer );
+      void flush_trx_batch();
       void cancel_sync(go_away_reason);
       void flush_queues();
       bool enqueue_sync_block();
@@ -653,7 +791,7 @@ namespace snax {
       void sync_timeout(boost::system::error_code ec);
       void fetch_timeout(boost::system::error_code ec);
 
-      void queue_write(std::shared_ptr<vector<char>> buff,
+      void queue_write(const send_buffer_ptr& buff,
                        bool trigger_send,
                        std::function<void(boost::system::error_code, std::size_t)> callback,
                        bool to_sync_queue = false);
@@ -670,6 +808,13 @@ namespace snax {
        */
       bool process_next_message(net_plugin_impl& impl, uint32_t message_length);
 
+      /** \brief Decode the next message on the decode thread pool, then handle it on the main thread
+       *
+       * Messages of a connection are unpacked in order on its strand and handled in the same order,
+       * as handlers are posted to the single threaded main io_service.
+       */
+      void queue_decode(net_plugin_impl& impl, uint32_t message_length);
+
       bool add_peer_block(const peer_block_state& pbs);
 
       fc::optional<fc::variant_object> _logger_variant;
@@ -701,13 +846,19 @@ namespace snax {
    struct msgHandler : public fc::visitor<void> {
       net_plugin_impl &impl;
       connection_ptr c;
-      msgHandler( net_plugin_impl &imp, connection_ptr conn) : impl(imp), c(conn) {}
+      const received_block_bytes* raw; ///< set when the visited message is a signed_block kept as received
+      msgHandler( net_plugin_impl &imp, connection_ptr conn, const received_block_bytes* r = nullptr) : impl(imp), c(conn), raw(r) {}
 
       template <typename T>
       void operator()(const T &msg) const
       {
          impl.handle_message( c, msg);
       }
+
+      void operator()(const signed_block &msg) const
+      {
+         impl.handle_message( c, msg, raw);
+      }
    };
 
    class sync_manager {
@@ -718,19 +869,43 @@ namespace snax {
          in_sync
       };
 
+      /// a range of blocks requested from a single peer
+      struct sync_range {
+         uint32_t       start = 0;
+         uint32_t       end = 0;
+         uint32_t       last_received = 0;  ///< highest block of the range received so far, 0 for none
+         fc::time_point requested;
+      };
+
+      struct sync_peer {
+         uint32_t             span = 0;  ///< blocks to request at once, adapted to the throughput of the peer
+         optional<sync_range> range;     ///< in flight
+      };
+
       uint32_t       sync_known_lib_num;
-      uint32_t       sync_last_requested_num;
+      uint32_t       sync_last_requested_num;  ///< highest block handed out in a range, 0 to start over from sync_next_expected_num
       uint32_t       sync_next_expected_num;
       uint32_t       sync_req_span;
-      connection_ptr source;
+      uint32_t       sync_max_peers;
       stages         state;
 
+      std::map<connection_ptr, sync_peer>  sync_peers;
+      std::map<uint32_t, uint32_t>         unassigned_ranges;  ///< start -> end, taken back from stalled or closed peers
+      /// lib catchup blocks received ahead of sync_next_expected_num, applied once the blocks before them are
+      std::map<uint32_t, std::pair<connection_ptr, signed_block_ptr>> reorder_buffer;
+
       chain_plugin* chain_plug = nullptr;
 
       constexpr auto stage_str(stages s );
 
+      void reset_ranges();
+      void release_range(connection_ptr c);
+      void range_received(connection_ptr c, uint32_t blk_num);
+      uint32_t ranges_in_flight()const;
+      uint32_t max_span()const { return sync_req_span * 4; }
+
    public:
-      explicit sync_manager(uint32_t span);
+      sync_manager(uint32_t span, uint32_t max_peers);
       void set_state(stages s);
       bool sync_required();
       void send_handshakes();
@@ -738,6 +913,10 @@ namespace snax {
       void reset_lib_num(connection_ptr conn);
       void request_next_chunk(connection_ptr conn = connection_ptr() );
       void start_sync(connection_ptr c, uint32_t target);
+      bool buffer_block(connection_ptr c, const signed_block& blk);
+      bool next_buffered_block(connection_ptr& c, signed_block_ptr& blk);
+      sync_progress progress();
+      void peer_progress(const connection_ptr& c, peer_telemetry& t)const;
       void reassign_fetch(connection_ptr c, go_away_reason reason);
       void verify_catchup(connection_ptr c, uint32_t num, block_id_type id);
       void rejected_block(connection_ptr c, uint32_t blk_num);
@@ -771,7 +950,7 @@ namespace snax {
 
    connection::connection( string endpoint )
       : blk_state(),
-        trx_state(),
+        known_trxs(),
         peer_requested(),
         socket( std::make_shared<tcp::socket>( std::ref( app().get_io_service() ))),
         node_id(),
@@ -796,7 +975,7 @@ namespace snax {
 
    connection::connection( socket_ptr s )
       : blk_state(),
-        trx_state(),
+        known_trxs(),
         peer_requested(),
         socket( s ),
         node_id(),
@@ -839,7 +1018,10 @@ namespace snax {
    void connection::reset() {
       peer_requested.reset();
       blk_state.clear();
-      trx_state.clear();
+      known_trxs.clear();
+      pending_compact_blocks.clear();
+      trx_batch.clear();
+      trx_batch_size = 0;
    }
 
    void connection::flush_queues() {
@@ -868,11 +1050,13 @@ namespace snax {
       cancel_wait();
       if( read_delay_timer ) read_delay_timer->cancel();
       pending_message_buffer.reset();
+      ++session_id;
+      decode_in_progress_size = 0;
    }
 
    void connection::txn_send_pending(const vector<transaction_id_type> &ids) {
       for(auto tx = my_impl->local_txns.begin(); tx != my_impl->local_txns.end(); ++tx ){
-         if(tx->serialized_txn.size() && tx->block_num == 0) {
+         if(tx->serialized_txn && tx->block_num == 0) {
             bool found = false;
             for(auto known : ids) {
                if( known == tx->id) {
@@ -881,8 +1065,9 @@ namespace snax {
                }
             }
             if(!found) {
+               known_trxs.insert(tx->id);
                my_impl->local_txns.modify(tx,incr_in_flight);
-               queue_write(std::make_shared<vector<char>>(tx->serialized_txn),
+               queue_write(tx->serialized_txn,
                            true,
                            [tx_id=tx->id](boost::system::error_code ec, std::size_t ) {
                               auto& local_txns = my_impl->local_txns;
@@ -901,9 +1086,10 @@ namespace snax {
    void connection::txn_send(const vector<transaction_id_type> &ids) {
       for(auto t : ids) {
          auto tx = my_impl->local_txns.get<by_id>().find(t);
-         if( tx != my_impl->local_txns.end() && tx->serialized_txn.size()) {
+         if( tx != my_impl->local_txns.end() && tx->serialized_txn) {
+            known_trxs.insert(t);
             my_impl->local_txns.modify( tx,incr_in_flight);
-            queue_write(std::make_shared<vector<char>>(tx->serialized_txn),
+            queue_write(tx->serialized_txn,
                         true,
                         [t](boost::system::error_code ec, std::size_t ) {
                            auto& local_txns = my_impl->local_txns;
@@ -1036,10 +1222,11 @@ namespace snax {
       enqueue(xpkt);
    }
 
-   void connection::queue_write(std::shared_ptr<vector<char>> buff,
+   void connection::queue_write(const send_buffer_ptr& buff,
                                 bool trigger_send,
                                 std::function<void(boost::system::error_code, std::size_t)> callback,
                                 bool to_sync_queue) {
+      count_traffic( uint8_t((*buff)[message_header_size]), buff->size(), true );
       if( !buffer_queue.add_write_queue( buff, callback, to_sync_queue )) {
          fc_wlog( logger, "write_queue full ${s} bytes, giving up on connection ${p}",
                   ("s", buffer_queue.write_queue_size())("p", peer_name()) );
@@ -1142,12 +1329,7 @@ namespace snax {
       return false;
    }
 
-   void connection::enqueue( const net_message &m, bool trigger_send, bool to_sync_queue ) {
-      go_away_reason close_after_send = no_reason;
-      if (m.contains<go_away_message>()) {
-         close_after_send = m.get<go_away_message>().reason;
-      }
-
+   static send_buffer_ptr create_send_buffer( const net_message& m ) {
       uint32_t payload_size = fc::raw::pack_size( m );
       char * header = reinterpret_cast<char*>(&payload_size);
       size_t header_size = sizeof(payload_size);
@@ -1158,6 +1340,209 @@ namespace snax {
       fc::datastream<char*> ds( send_buffer->data(), buffer_size);
       ds.write( header, header_size );
       fc::raw::pack( ds, m );
+      return send_buffer;
+   }
+
+   /// frames the message_length bytes at the read position of buffer, past their size prefix, without consuming them
+   static std::shared_ptr<vector<char>> peek_framed_message( fc::message_buffer<1024*1024>& buffer, uint32_t message_length ) {
+      auto framed = std::make_shared<vector<char>>( message_header_size + message_length );
+      memcpy( framed->data(), &message_length, message_header_size );
+      auto index = buffer.read_index();
+      buffer.peek( framed->data() + message_header_size, message_length, index );
+      return framed;
+   }
+
+   /// the id of the framed signed_block message, see block_header::id
+   static block_id_type block_id_from_raw( const vector<char>& framed ) {
+      fc::datastream<const char*> ds( framed.data() + message_header_size, framed.size() - message_header_size );
+      fc::unsigned_int which;
+      fc::raw::unpack( ds, which );
+      const auto header_pos = ds.tellp();
+      block_header header;
+      fc::raw::unpack( ds, header );
+
+      block_id_type result = digest_type::hash( framed.data() + message_header_size + header_pos, ds.tellp() - header_pos );
+      result._hash[0] &= 0xffffffff00000000;
+      result._hash[0] += fc::endian_reverse_u32( header.block_num() );
+      return result;
+   }
+
+   /// splices packed_transaction messages framed by create_send_buffer into one transaction_batch_message
+   static send_buffer_ptr create_trx_batch_send_buffer( const vector<send_buffer_ptr>& trx_buffers ) {
+      const fc::unsigned_int which( net_message::tag<transaction_batch_message>::value );
+      const fc::unsigned_int count( trx_buffers.size() );
+      const size_t trx_prefix_size = message_header_size + fc::raw::pack_size( fc::unsigned_int( net_message::tag<packed_transaction>::value ) );
+
+      uint32_t payload_size = fc::raw::pack_size( which ) + fc::raw::pack_size( count );
+      for( const auto& b : trx_buffers ) {
+         payload_size += b->size() - trx_prefix_size;
+      }
+      char * header = reinterpret_cast<char*>(&payload_size);
+      size_t header_size = sizeof(payload_size);
+
+      size_t buffer_size = header_size + payload_size;
+
+      auto send_buffer = std::make_shared<vector<char>>(buffer_size);
+      fc::datastream<char*> ds( send_buffer->data(), buffer_size);
+      ds.write( header, header_size );
+      fc::raw::pack( ds, which );
+      fc::raw::pack( ds, count );
+      for( const auto& b : trx_buffers ) {
+         ds.write( b->data() + trx_prefix_size, b->size() - trx_prefix_size );
+      }
+      return send_buffer;
+   }
+
+   namespace bio = boost::iostreams;
+
+   /// rejects decompressed data beyond the size limit of a received message
+   struct decompress_limiter {
+      using char_type = char;
+      using category = bio::multichar_output_filter_tag;
+
+      template<typename Sink>
+      std::streamsize write( Sink& sink, const char* s, std::streamsize count ) {
+         SNAX_ASSERT( _total + count <= def_send_buffer_size*2, plugin_exception, "compressed message exceeds the maximum message size" );
+         _total += count;
+         return bio::write( sink, s, count );
+      }
+
+      size_t _total = 0;
+   };
+
+   /// frames m as a compressed_message when it is large enough and compresses well, otherwise as create_send_buffer
+   static send_buffer_ptr create_compressed_send_buffer( const net_message& m, uint64_t& compress_time_us ) {
+      if( fc::raw::pack_size( m ) < def_min_compress_size )
+         return create_send_buffer( m );
+
+      auto start = fc::time_point::now();
+      const auto packed = fc::raw::pack( m );
+      compressed_message cm;
+      cm.uncompressed_size = packed.size();
+      {
+         bio::filtering_ostream comp;
+         comp.push( bio::zlib_compressor( bio::zlib::best_speed ) );
+         comp.push( bio::back_inserter( cm.data ) );
+         bio::write( comp, packed.data(), packed.size() );
+         bio::close( comp );
+      }
+      compress_time_us += (fc::time_point::now() - start).count();
+
+      // not worth the receiver's time
+      if( cm.data.size() > packed.size() / 10 * 9 )
+         return create_send_buffer( m );
+      return create_send_buffer( net_message( std::move(cm) ) );
+   }
+
+   static net_message decompress_message( const compressed_message& cm, compression_stats& stats ) {
+      auto start = fc::time_point::now();
+      bytes packed;
+      packed.reserve( std::min<uint32_t>( cm.uncompressed_size, def_send_buffer_size*2 ) );
+      try {
+         bio::filtering_ostream decomp;
+         decomp.push( bio::zlib_decompressor() );
+         decomp.push( decompress_limiter() );
+         decomp.push( bio::back_inserter( packed ) );
+         bio::write( decomp, cm.data.data(), cm.data.size() );
+         bio::close( decomp );
+      } catch( fc::exception& ) {
+         throw;
+      } catch( ... ) {
+         fc::unhandled_exception er( FC_LOG_MESSAGE( warn, "internal decompression error" ), std::current_exception() );
+         throw er;
+      }
+
+      net_message msg;
+      fc::datastream<const char*> ds( packed.data(), packed.size() );
+      fc::raw::unpack( ds, msg );
+      SNAX_ASSERT( !msg.contains<compressed_message>(), plugin_exception, "nested compressed message" );
+
+      ++stats.messages_received;
+      stats.bytes_received += cm.data.size();
+      stats.uncompressed_bytes_received += packed.size();
+      stats.decompress_time_us += (fc::time_point::now() - start).count();
+      return msg;
+   }
+
+   bool connection::compression_enabled()const {
+      return my_impl->compression && protocol_version >= proto_compression;
+   }
+
+   bool connection::trx_batching_enabled()const {
+      return my_impl->trx_batch_window.count() > 0 && protocol_version >= proto_trx_batch;
+   }
+
+   void connection::add_to_trx_batch( const send_buffer_ptr& trx_buffer ) {
+      trx_batch.push_back( trx_buffer );
+      trx_batch_size += trx_buffer->size();
+      if( trx_batch_size >= def_trx_batch_size ) {
+         flush_trx_batch();
+      } else {
+         my_impl->start_trx_batch_timer();
+      }
+   }
+
+   void connection::flush_trx_batch() {
+      if( trx_batch.empty() ) {
+         return;
+      }
+      fc_dlog(logger, "sending batch of ${n} trxs to ${p}", ("n", trx_batch.size())("p", peer_name()));
+      if( trx_batch.size() == 1 ) {
+         enqueue_buffer( trx_batch.front(), true, false, no_reason );
+      } else {
+         enqueue_buffer( create_trx_batch_send_buffer( trx_batch ), true, false, no_reason );
+      }
+      trx_batch.clear();
+      trx_batch_size = 0;
+   }
+
+   /**
+    *  A broadcast serialized lazily, at most once uncompressed and once compressed, each buffer shared
+    *  by all the connections it is queued on.
+    */
+   class broadcast_buffer {
+   public:
+      explicit broadcast_buffer( net_message msg, send_buffer_ptr plain = send_buffer_ptr() )
+      : _msg( std::move(msg) ),_plain( std::move(plain) ) {}
+
+      const send_buffer_ptr& get( connection& c ) {
+         if( c.compression_enabled() ) {
+            if( !_compressed )
+               _compressed = create_compressed_send_buffer( _msg, c.compression.compress_time_us );
+            return _compressed;
+         }
+         if( !_plain )
+            _plain = create_send_buffer( _msg );
+         return _plain;
+      }
+
+   private:
+      net_message      _msg;
+      send_buffer_ptr  _plain;
+      send_buffer_ptr  _compressed;
+   };
+
+   void connection::enqueue( const net_message &m, bool trigger_send, bool to_sync_queue ) {
+      go_away_reason close_after_send = no_reason;
+      if (m.contains<go_away_message>()) {
+         close_after_send = m.get<go_away_message>().reason;
+      }
+
+      enqueue_buffer( compression_enabled() ? create_compressed_send_buffer( m, compression.compress_time_us ) : create_send_buffer( m ),
+                      trigger_send, to_sync_queue, close_after_send );
+   }
+
+   void connection::enqueue_buffer( const send_buffer_ptr& send_buffer, bool trigger_send, bool to_sync_queue,
+                                    go_away_reason close_after_send ) {
+      // the variant tag follows the size prefix, a single byte for every net_message type
+      if( send_buffer->size() > message_header_size + 1 + sizeof(uint32_t) &&
+          uint8_t((*send_buffer)[message_header_size]) == net_message::tag<compressed_message>::value ) {
+         uint32_t uncompressed_size = 0;
+         memcpy( &uncompressed_size, send_buffer->data() + message_header_size + 1, sizeof(uncompressed_size) );
+         ++compression.messages_sent;
+         compression.bytes_sent += send_buffer->size();
+         compression.uncompressed_bytes_sent += uncompressed_size;
+      }
 
       connection_wptr weak_this = shared_from_this();
       queue_write(send_buffer,trigger_send,
@@ -1254,7 +1639,7 @@ namespace snax {
 
    bool connection::process_next_message(net_plugin_impl& impl, uint32_t message_length) {
       try {
-         // If it is a signed_block, then save the raw message for the cache
+         // If it is a signed_block, then keep the raw message to relay it as received
          // This must be done before we unpack the message.
          // This code is copied from fc::io::unpack(..., unsigned_int)
          auto index = pending_message_buffer.read_index();
@@ -1265,15 +1650,16 @@ namespace snax {
             by += 7;
          } while( uint8_t(b) & 0x80 && by < 32);
 
+         optional<received_block_bytes> raw;
          if (which == uint64_t(net_message::tag<signed_block>::value)) {
-            blk_buffer.resize(message_length);
-            auto index = pending_message_buffer.read_index();
-            pending_message_buffer.peek(blk_buffer.data(), message_length, index);
+            auto bytes = peek_framed_message( pending_message_buffer, message_length );
+            raw = received_block_bytes{ block_id_from_raw( *bytes ), std::move(bytes) };
          }
          auto ds = pending_message_buffer.create_datastream();
          net_message msg;
          fc::raw::unpack(ds, msg);
-         msgHandler m(impl, shared_from_this() );
+         count_traffic( msg.which(), message_header_size + message_length, false );
+         msgHandler m(impl, shared_from_this(), raw ? &*raw : nullptr );
          msg.visit(m);
       } catch(  const fc::exception& e ) {
          edump((e.to_detail_string() ));
@@ -1283,6 +1669,56 @@ namespace snax {
       return true;
    }
 
+   void connection::queue_decode(net_plugin_impl& impl, uint32_t message_length) {
+      // framed, so a signed_block can be relayed as received
+      send_buffer_ptr raw = peek_framed_message( pending_message_buffer, message_length );
+      pending_message_buffer.advance_read_ptr( message_length );
+
+      if( !decode_strand )
+         decode_strand.emplace( impl.decode_pool->get_executor() );
+      decode_in_progress_size += message_length;
+
+      connection_wptr weak_this = shared_from_this();
+      boost::asio::post( *decode_strand, [&impl, weak_this, raw, session = session_id]() {
+         auto msg = std::make_shared<net_message>();
+         optional<received_block_bytes> block_raw;
+         optional<uint32_t> wire_which; ///< the type as received, before decompression
+         compression_stats stats;
+         fc::exception_ptr except;
+         try {
+            fc::datastream<const char*> ds( raw->data() + message_header_size, raw->size() - message_header_size );
+            fc::raw::unpack( ds, *msg );
+            wire_which = msg->which();
+            if( msg->contains<compressed_message>() )
+               *msg = decompress_message( msg->get<compressed_message>(), stats );
+            else if( msg->contains<signed_block>() )
+               block_raw = received_block_bytes{ block_id_from_raw( *raw ), raw };
+         } catch( const fc::exception& e ) {
+            except = e.dynamic_copy_exception();
+         }
+
+         app().get_io_service().post( [&impl, weak_this, raw, session, msg, block_raw, wire_which, stats, except]() {
+            auto conn = weak_this.lock();
+            if( !conn || conn->session_id != session ) return;
+            conn->decode_in_progress_size -= raw->size() - message_header_size;
+            if( wire_which )
+               conn->count_traffic( *wire_which, raw->size(), false );
+            conn->compression.messages_received           += stats.messages_received;
+            conn->compression.bytes_received              += stats.bytes_received;
+            conn->compression.uncompressed_bytes_received += stats.uncompressed_bytes_received;
+            conn->compression.decompress_time_us          += stats.decompress_time_us;
+            try {
+               if( except ) except->dynamic_rethrow_exception();
+               msgHandler m( impl, conn, block_raw ? &*block_raw : nullptr );
+               msg->visit( m );
+            } catch( const fc::exception& e ) {
+               edump((e.to_detail_string() ));
+               impl.close( conn );
+            }
+         });
+      });
+   }
+
    bool connection::add_peer_block(const peer_block_state& entry) {
       auto bptr = blk_state.get<by_id>().find(entry.id);
       bool added = (bptr == blk_state.end());
@@ -1303,12 +1739,12 @@ namespace snax {
 
    //-----------------------------------------------------------
 
-    sync_manager::sync_manager( uint32_t req_span )
+    sync_manager::sync_manager( uint32_t req_span, uint32_t max_peers )
       :sync_known_lib_num( 0 )
       ,sync_last_requested_num( 0 )
       ,sync_next_expected_num( 1 )
-      ,sync_req_span( req_span )
-      ,source()
+      ,sync_req_span( std::max<uint32_t>( req_span, 1 ) )
+      ,sync_max_peers( std::max<uint32_t>( max_peers, 1 ) )
       ,state(in_sync)
    {
       chain_plug = app( ).find_plugin<chain_plugin>( );
@@ -1330,6 +1766,68 @@ namespace snax {
       }
       fc_dlog(logger, "old state ${os} becoming ${ns}",("os",stage_str (state))("ns",stage_str (newstate)));
       state = newstate;
+      if (state == in_sync) {
+         reset_ranges();
+      }
+   }
+
+   void sync_manager::reset_ranges() {
+      for( auto& p : sync_peers ) {
+         p.second.range.reset();
+      }
+      unassigned_ranges.clear();
+      reorder_buffer.clear();
+   }
+
+   uint32_t sync_manager::ranges_in_flight()const {
+      uint32_t n = 0;
+      for( const auto& p : sync_peers ) {
+         if( p.second.range ) ++n;
+      }
+      return n;
+   }
+
+   // leaves the part of the range of c not received yet to the next idle peer
+   void sync_manager::release_range( connection_ptr c ) {
+      auto it = sync_peers.find( c );
+      if( it == sync_peers.end() || !it->second.range ) {
+         return;
+      }
+      const auto& r = *it->second.range;
+      uint32_t start = std::max( { r.start, r.last_received + 1, sync_next_expected_num } );
+      if( start <= r.end ) {
+         fc_dlog(logger, "range ${s} to ${e} from ${p} released",("s",start)("e",r.end)("p",c->peer_name()));
+         unassigned_ranges[start] = r.end;
+      }
+      it->second.range.reset();
+   }
+
+   void sync_manager::range_received( connection_ptr c, uint32_t blk_num ) {
+      auto it = sync_peers.find( c );
+      if( it == sync_peers.end() || !it->second.range ) {
+         return;
+      }
+      auto& peer = it->second;
+      auto& r = *peer.range;
+      if( blk_num < r.start || blk_num > r.end ) {
+         return;
+      }
+      r.last_received = std::max( r.last_received, blk_num );
+      if( blk_num != r.end ) {
+         fc_dlog(logger,"calling sync_wait on connection ${p}",("p",c->peer_name()));
+         c->sync_wait();
+         return;
+      }
+
+      // size the next range of the peer so it takes about def_sync_range_target_time
+      int64_t elapsed_us = std::max<int64_t>( (fc::time_point::now() - r.requested).count(), 1 );
+      uint64_t target_span = uint64_t( r.end - r.start + 1 ) * std::chrono::microseconds( def_sync_range_target_time ).count() / elapsed_us;
+      uint64_t span = std::max<uint64_t>( (uint64_t( peer.span ) + target_span) / 2, std::max<uint32_t>( sync_req_span / 10, 1 ) );
+      peer.span = std::min<uint64_t>( span, max_span() );
+      fc_dlog(logger, "range ${s} to ${e} from ${p} took ${t} ms, span is now ${n}",
+              ("s",r.start)("e",r.end)("p",c->peer_name())("t",elapsed_us / 1000)("n",peer.span));
+      peer.range.reset();
+      request_next_chunk( c );
    }
 
    bool sync_manager::is_active(connection_ptr c) {
@@ -1343,16 +1841,20 @@ namespace snax {
    }
 
    void sync_manager::reset_lib_num(connection_ptr c) {
-      if(state == in_sync) {
-         source.reset();
-      }
       if( c->current() ) {
          if( c->last_handshake_recv.last_irreversible_block_num > sync_known_lib_num) {
             sync_known_lib_num =c->last_handshake_recv.last_irreversible_block_num;
          }
-      } else if( c == source ) {
-         sync_last_requested_num = 0;
-         request_next_chunk();
+      } else {
+         auto it = sync_peers.find( c );
+         if( it != sync_peers.end() ) {
+            bool had_range = !!it->second.range;
+            release_range( c );
+            sync_peers.erase( it );
+            if( had_range ) {
+               request_next_chunk();
+            }
+         }
       }
    }
 
@@ -1365,67 +1867,30 @@ namespace snax {
    }
 
    void sync_manager::request_next_chunk( connection_ptr conn ) {
-      uint32_t head_block = chain_plug->chain().fork_db_head_block_num();
-
-      if (head_block < sync_last_requested_num && source && source->current()) {
-         fc_ilog (logger, "ignoring request, head is ${h} last req = ${r} source is ${p}",
-                  ("h",head_block)("r",sync_last_requested_num)("p",source->peer_name()));
-         return;
-      }
-
       /* ----------
-       * next chunk provider selection criteria
-       * a provider is supplied and able to be used, use it.
-       * otherwise select the next available from the list, round-robin style.
+       * ranges are handed to idle peers able to provide sync blocks, up to sync_max_peers at once.
+       * a supplied provider is asked first, then the others by the span they earned, fastest first.
+       * ranges taken back from stalled or closed peers go out before new ones. new ranges stay within
+       * a window past sync_next_expected_num to bound the reorder buffer.
        */
-
-      if (conn && conn->current() ) {
-         source = conn;
-      }
-      else {
-         if (my_impl->connections.size() == 1) {
-            if (!source) {
-               source = *my_impl->connections.begin();
-            }
+      vector<connection_ptr> idle;
+      bool have_source = false;
+      for( const auto& c : my_impl->connections ) {
+         if( !c->current() ) {
+            continue;
          }
-         else {
-            // init to a linear array search
-            auto cptr = my_impl->connections.begin();
-            auto cend = my_impl->connections.end();
-            // do we remember the previous source?
-            if (source) {
-               //try to find it in the list
-               cptr = my_impl->connections.find(source);
-               cend = cptr;
-               if (cptr == my_impl->connections.end()) {
-                  //not there - must have been closed! cend is now connections.end, so just flatten the ring.
-                  source.reset();
-                  cptr = my_impl->connections.begin();
-               } else {
-                  //was found - advance the start to the next. cend is the old source.
-                  if (++cptr == my_impl->connections.end() && cend != my_impl->connections.end() ) {
-                     cptr = my_impl->connections.begin();
-                  }
-               }
-            }
-
-            //scan the list of peers looking for another able to provide sync blocks.
-            auto cstart_it = cptr;
-            do {
-               //select the first one which is current and break out.
-               if((*cptr)->current()) {
-                  source = *cptr;
-                  break;
-               }
-               if(++cptr == my_impl->connections.end())
-                     cptr = my_impl->connections.begin();
-            } while(cptr != cstart_it);
-            // no need to check the result, either source advanced or the whole list was checked and the old source is reused.
+         have_source = true;
+         auto& peer = sync_peers[c];
+         if( peer.span == 0 ) {
+            peer.span = sync_req_span;
+         }
+         if( !peer.range ) {
+            idle.push_back( c );
          }
       }
 
       // verify there is an available source
-      if (!source || !source->current() ) {
+      if( !have_source ) {
          elog("Unable to continue syncing at this time");
          sync_known_lib_num = chain_plug->chain().last_irreversible_block_num();
          sync_last_requested_num = 0;
@@ -1433,17 +1898,49 @@ namespace snax {
          return;
       }
 
-      if( sync_last_requested_num != sync_known_lib_num ) {
-         uint32_t start = sync_next_expected_num;
-         uint32_t end = start + sync_req_span - 1;
-         if( end > sync_known_lib_num )
-            end = sync_known_lib_num;
-         if( end > 0 && end >= start ) {
-            fc_ilog(logger, "requesting range ${s} to ${e}, from ${n}",
-                    ("n",source->peer_name())("s",start)("e",end));
-            source->request_sync_blocks(start, end);
+      std::stable_sort( idle.begin(), idle.end(), [&]( const connection_ptr& a, const connection_ptr& b ) {
+         if( a == conn || b == conn ) {
+            return a == conn && b != conn;
+         }
+         return sync_peers[a].span > sync_peers[b].span;
+      } );
+
+      while( !unassigned_ranges.empty() && unassigned_ranges.begin()->second < sync_next_expected_num ) {
+         unassigned_ranges.erase( unassigned_ranges.begin() );
+      }
+
+      uint32_t in_flight = ranges_in_flight();
+      const uint32_t window_end = sync_next_expected_num + sync_max_peers * max_span() - 1;
+      for( const auto& c : idle ) {
+         if( in_flight >= sync_max_peers ) {
+            break;
+         }
+         auto& peer = sync_peers[c];
+         uint32_t start = 0;
+         uint32_t end = 0;
+         if( !unassigned_ranges.empty() ) {
+            auto it = unassigned_ranges.begin();
+            start = std::max( it->first, sync_next_expected_num );
+            end = std::min( it->second, start + peer.span - 1 );
+            if( end < it->second ) {
+               unassigned_ranges[end + 1] = it->second;
+            }
+            unassigned_ranges.erase( it );
+         } else if( sync_last_requested_num < sync_known_lib_num ) {
+            start = std::max( sync_last_requested_num + 1, sync_next_expected_num );
+            end = std::min( { start + peer.span - 1, sync_known_lib_num, window_end } );
+            if( end < start ) {
+               break;
+            }
             sync_last_requested_num = end;
+         } else {
+            break;
          }
+         fc_ilog(logger, "requesting range ${s} to ${e}, from ${n}",
+                 ("n",c->peer_name())("s",start)("e",end));
+         peer.range = sync_range{ start, end, 0, fc::time_point::now() };
+         c->request_sync_blocks(start, end);
+         ++in_flight;
       }
    }
 
@@ -1484,9 +1981,12 @@ namespace snax {
       fc_ilog(logger, "reassign_fetch, our last req is ${cc}, next expected is ${ne} peer ${p}",
               ( "cc",sync_last_requested_num)("ne",sync_next_expected_num)("p",c->peer_name()));
 
-      if (c == source) {
+      auto it = sync_peers.find( c );
+      if( it != sync_peers.end() && it->second.range ) {
          c->cancel_sync (reason);
-         sync_last_requested_num = 0;
+         release_range( c );
+         // stalled, let the faster peers go first
+         it->second.span = std::max<uint32_t>( it->second.span / 2, 1 );
          request_next_chunk();
       }
    }
@@ -1616,15 +2116,19 @@ namespace snax {
       if (state != in_sync ) {
          fc_ilog (logger, "block ${bn} not accepted from ${p}",("bn",blk_num)("p",c->peer_name()));
          sync_last_requested_num = 0;
-         source.reset();
-         my_impl->close(c);
          set_state(in_sync);
+         my_impl->close(c);
          send_handshakes();
       }
    }
    void sync_manager::recv_block (connection_ptr c, const block_id_type &blk_id, uint32_t blk_num) {
       fc_dlog(logger," got block ${bn} from ${p}",("bn",blk_num)("p",c->peer_name()));
       if (state == lib_catchup) {
+         if (blk_num < sync_next_expected_num) {
+            // a range taken back from a stalled peer may still arrive from it
+            fc_dlog(logger, "already have block ${bn}, expecting ${ne}",("bn",blk_num)("ne",sync_next_expected_num));
+            return;
+         }
          if (blk_num != sync_next_expected_num) {
             fc_ilog (logger, "expected block ${ne} but got ${bn}",("ne",sync_next_expected_num)("bn",blk_num));
             my_impl->close(c);
@@ -1635,7 +2139,6 @@ namespace snax {
       if (state == head_catchup) {
          fc_dlog (logger, "sync_manager in head_catchup state");
          set_state(in_sync);
-         source.reset();
 
          block_id_type null_id;
          for (auto cp : my_impl->connections) {
@@ -1657,31 +2160,135 @@ namespace snax {
             set_state(in_sync);
             send_handshakes();
          }
-         else if (blk_num == sync_last_requested_num) {
+         else if( (sync_last_requested_num < sync_known_lib_num || !unassigned_ranges.empty()) &&
+                  ranges_in_flight() < sync_max_peers ) {
+            // the window for new ranges moved on
             request_next_chunk();
          }
-         else {
-            fc_dlog(logger,"calling sync_wait on connection ${p}",("p",c->peer_name()));
-            c->sync_wait();
-         }
       }
    }
 
+   bool sync_manager::buffer_block( connection_ptr c, const signed_block& blk ) {
+      if( state == in_sync ) {
+         return false;
+      }
+      uint32_t blk_num = blk.block_num();
+      range_received( c, blk_num );
+      if( state != lib_catchup || blk_num <= sync_next_expected_num || blk_num > sync_last_requested_num ) {
+         return false;
+      }
+      if( reorder_buffer.find( blk_num ) == reorder_buffer.end() ) {
+         fc_dlog(logger, "holding block ${bn} from ${p} until ${ne} arrives",("bn",blk_num)("p",c->peer_name())("ne",sync_next_expected_num));
+         reorder_buffer.emplace( blk_num, std::make_pair( c, std::make_shared<signed_block>( blk ) ) );
+      }
+      return true;
+   }
+
+   sync_progress sync_manager::progress() {
+      sync_progress p;
+      p.state = stage_str(state);
+      p.known_lib_num = sync_known_lib_num;
+      p.next_expected_num = sync_next_expected_num;
+      p.last_requested_num = sync_last_requested_num;
+      p.ranges_in_flight = ranges_in_flight();
+      p.unassigned_ranges = unassigned_ranges.size();
+      p.buffered_blocks = reorder_buffer.size();
+      return p;
+   }
+
+   void sync_manager::peer_progress( const connection_ptr& c, peer_telemetry& t )const {
+      auto it = sync_peers.find( c );
+      if( it == sync_peers.end() ) {
+         return;
+      }
+      t.sync_span = it->second.span;
+      if( it->second.range ) {
+         t.sync_range_start = it->second.range->start;
+         t.sync_range_end = it->second.range->end;
+         t.sync_range_last_received = it->second.range->last_received;
+      }
+   }
+
+   bool sync_manager::next_buffered_block( connection_ptr& c, signed_block_ptr& blk ) {
+      while( !reorder_buffer.empty() && reorder_buffer.begin()->first < sync_next_expected_num ) {
+         reorder_buffer.erase( reorder_buffer.begin() );
+      }
+      if( state != lib_catchup || reorder_buffer.empty() || reorder_buffer.begin()->first != sync_next_expected_num ) {
+         return false;
+      }
+      c = reorder_buffer.begin()->second.first;
+      blk = reorder_buffer.begin()->second.second;
+      reorder_buffer.erase( reorder_buffer.begin() );
+      return true;
+   }
+
+   //------------------------------------------------------------------------
+
+   struct type_name_visitor : public fc::visitor<string> {
+      template<typename T>
+      string operator()( const T& )const { return fc::get_typename<T>::name(); }
+   };
+
+   /// the name of the net_message type with tag which
+   static string message_type_name( uint32_t which ) {
+      type_name_visitor visitor;
+      net_message msg;
+      msg.set_which( which );
+      return msg.visit( visitor );
+   }
+
+   peer_telemetry connection::get_telemetry()const {
+      peer_telemetry t;
+      t.peer = peer_addr;
+      t.connecting = connecting;
+      t.syncing = syncing;
+      t.head_num = last_handshake_recv.head_num;
+      t.last_irreversible_block_num = last_handshake_recv.last_irreversible_block_num;
+      for( uint32_t which = 0; which < traffic.size(); ++which ) {
+         const auto& tc = traffic[which];
+         if( tc.messages_sent == 0 && tc.messages_received == 0 ) {
+            continue;
+         }
+         t.messages.push_back( message_type_stats{ message_type_name( which ),
+                                                   tc.messages_sent, tc.bytes_sent, tc.messages_received, tc.bytes_received } );
+      }
+      t.write_queue_bytes = buffer_queue.write_queue_size();
+      t.write_queue_messages = buffer_queue.write_queue_count();
+      t.sync_write_queue_messages = buffer_queue.sync_write_queue_count();
+      t.out_queue_messages = buffer_queue.out_queue_count();
+      t.blocks_received = blocks_received;
+      t.duplicate_blocks_received = duplicate_blocks_received;
+      t.trxs_received = trxs_received;
+      t.duplicate_trxs_received = duplicate_trxs_received;
+      t.block_latency_samples = block_latency_samples;
+      if( block_latency_samples > 0 ) {
+         t.avg_block_latency_us = block_latency_sum_us / int64_t(block_latency_samples);
+      }
+      t.max_block_latency_us = max_block_latency_us;
+      return t;
+   }
+
    //------------------------------------------------------------------------
 
    void dispatch_manager::bcast_block (const signed_block &bsum) {
       std::set<connection_ptr> skips;
-      auto range = received_blocks.equal_range(bsum.id());
+      block_id_type bid = bsum.id();
+      auto range = received_blocks.equal_range(bid);
       for (auto org = range.first; org != range.second; ++org) {
          skips.insert(org->second);
       }
       received_blocks.erase(range.first, range.second);
 
+      // a block received from a peer is relayed as it was received
+      send_buffer_ptr raw;
+      auto rb = my_impl->received_block_buffers.find( bid );
+      if( rb != my_impl->received_block_buffers.end() ) {
+         raw = rb->second;
+      }
+
       net_message msg(bsum);
-      uint32_t packsiz = fc::raw::pack_size(msg);
-      uint32_t msgsiz = packsiz + sizeof(packsiz);
+      uint32_t msgsiz = raw ? raw->size() : fc::raw::pack_size(msg) + sizeof(uint32_t);
       notice_message pending_notify;
-      block_id_type bid = bsum.id();
       uint32_t bnum = bsum.block_num();
       pending_notify.known_blocks.mode = normal;
       pending_notify.known_blocks.ids.push_back( bid );
@@ -1704,12 +2311,22 @@ namespace snax {
       }
       else {
          pbstate.is_known = true;
+         // serialized once, every peer's write queue shares the buffer
+         broadcast_buffer block_buffer( std::move(msg), std::move(raw) );
          for (auto cp : my_impl->connections) {
             if (skips.find(cp) != skips.end() || !cp->current()) {
                continue;
             }
             cp->add_peer_block(pbstate);
-            cp->enqueue( bsum );
+            if (my_impl->compact_blocks && cp->protocol_version >= proto_compact_blocks) {
+               // elides only what this peer is known to have, so the compact form differs per peer
+               auto compact = my_impl->make_compact_block( bsum, *cp );
+               if (compact) {
+                  cp->enqueue( net_message( std::move(*compact) ) );
+                  continue;
+               }
+            }
+            cp->enqueue_buffer( block_buffer.get( *cp ), true, false, no_reason );
          }
       }
    }
@@ -1768,38 +2385,29 @@ namespace snax {
          fc_dlog(logger, "found trxid in local_trxs" );
          return;
       }
-      uint32_t packsiz = 0;
-      uint32_t bufsiz = 0;
-
       time_point_sec trx_expiration = trx.expiration();
 
-      net_message msg(trx);
-      packsiz = fc::raw::pack_size(msg);
-      bufsiz = packsiz + sizeof(packsiz);
-      vector<char> buff(bufsiz);
-      fc::datastream<char*> ds( buff.data(), bufsiz);
-      ds.write( reinterpret_cast<char*>(&packsiz), sizeof(packsiz) );
-      fc::raw::pack( ds, msg );
+      const auto send_buffer = create_send_buffer( net_message(trx) );
+      uint32_t bufsiz = send_buffer->size();
       node_transaction_state nts = {id,
                                     trx_expiration,
-                                    trx,
-                                    std::move(buff),
+                                    send_buffer,
                                     0, 0, 0};
       my_impl->local_txns.insert(std::move(nts));
 
       if( !large_msg_notify || bufsiz <= just_send_it_max) {
-         my_impl->send_all( trx, [id, &skips, trx_expiration](connection_ptr c) -> bool {
+         my_impl->send_all( send_buffer, [id, &skips, &send_buffer](connection_ptr c) -> bool {
                if( skips.find(c) != skips.end() || c->syncing ) {
                   return false;
                }
-               const auto& bs = c->trx_state.find(id);
-               bool unknown = bs == c->trx_state.end();
+               bool unknown = !c->known_trxs.contains(id);
                if( unknown) {
-                  c->trx_state.insert(transaction_state({id,true,true,0,trx_expiration,time_point() }));
+                  c->known_trxs.insert(id);
+                  if( c->trx_batching_enabled() ) {
+                     c->add_to_trx_batch( send_buffer );
+                     return false;
+                  }
                   fc_dlog(logger, "sending whole trx to ${n}", ("n",c->peer_name() ) );
-               } else {
-                  update_txn_expiry ute(trx_expiration);
-                  c->trx_state.modify(bs, ute);
                }
                return unknown;
             });
@@ -1809,18 +2417,14 @@ namespace snax {
          pending_notify.known_trx.mode = normal;
          pending_notify.known_trx.ids.push_back( id );
          pending_notify.known_blocks.mode = none;
-         my_impl->send_all(pending_notify, [id, &skips, trx_expiration](connection_ptr c) -> bool {
+         my_impl->send_all(pending_notify, [id, &skips](connection_ptr c) -> bool {
                if (skips.find(c) != skips.end() || c->syncing) {
                   return false;
                }
-               const auto& bs = c->trx_state.find(id);
-               bool unknown = bs == c->trx_state.end();
+               // the peer only learns the id, it is known by the peer once it asks for the trx
+               bool unknown = !c->known_trxs.contains(id);
                if( unknown) {
                   fc_dlog(logger, "sending notice to ${n}", ("n",c->peer_name() ) );
-                  c->trx_state.insert(transaction_state({id,false,true,0,trx_expiration,time_point() }));
-               } else {
-                  update_txn_expiry ute(trx_expiration);
-                  c->trx_state.modify(bs, ute);
                }
                return unknown;
             });
@@ -1863,11 +2467,10 @@ namespace snax {
             if( tx == my_impl->local_txns.end( ) ) {
                fc_dlog(logger,"did not find ${id}",("id",t));
 
-               //At this point the details of the txn are not known, just its id. This
-               //effectively gives 120 seconds to learn of the details of the txn which
-               //will update the expiry in bcast_transaction
-               c->trx_state.insert( (transaction_state){t,true,true,0,time_point_sec(time_point::now()) + 120,
-                        time_point()} );
+               //At this point the details of the txn are not known, just its id. The peer
+               //is remembered to know it for at least def_known_trx_rotation_sec, so
+               //bcast_transaction does not send it back
+               c->known_trxs.insert( t );
 
                req.req_trx.ids.push_back( t );
                req_trx.push_back( t );
@@ -1946,8 +2549,7 @@ namespace snax {
          }
          bool sendit = false;
          if (is_txn) {
-            auto trx = conn->trx_state.get<by_id>().find(tid);
-            sendit = trx != conn->trx_state.end() && trx->is_known_by_peer;
+            sendit = conn->known_trxs.contains(tid);
          }
          else {
             auto blk = conn->blk_state.get<by_id>().find(bid);
@@ -2156,13 +2758,16 @@ namespace snax {
 
          if( conn->buffer_queue.write_queue_size() > def_max_write_queue_size ||
              conn->reads_in_flight > def_max_reads_in_flight   ||
-             conn->trx_in_progress_size > def_max_trx_in_progress_size )
+             conn->trx_in_progress_size > def_max_trx_in_progress_size ||
+             conn->decode_in_progress_size > def_max_decode_in_progress_size )
          {
             // too much queued up, reschedule
             if( conn->buffer_queue.write_queue_size() > def_max_write_queue_size ) {
                peer_wlog( conn, "write_queue full ${s} bytes", ("s", conn->buffer_queue.write_queue_size()) );
             } else if( conn->reads_in_flight > def_max_reads_in_flight ) {
                peer_wlog( conn, "max reads in flight ${s}", ("s", conn->reads_in_flight) );
+            } else if( conn->decode_in_progress_size > def_max_decode_in_progress_size ) {
+               peer_wlog( conn, "max decode in progress ${s} bytes", ("s", conn->decode_in_progress_size) );
             } else {
                peer_wlog( conn, "max trx in progress ${s} bytes", ("s", conn->trx_in_progress_size) );
             }
@@ -2225,7 +2830,9 @@ namespace snax {
 
                            if (bytes_in_buffer >= total_message_bytes) {
                               conn->pending_message_buffer.advance_read_ptr(message_header_size);
-                              if (!conn->process_next_message(*this, message_length)) {
+                              if (decode_pool) {
+                                 conn->queue_decode(*this, message_length);
+                              } else if (!conn->process_next_message(*this, message_length)) {
                                  return;
                               }
                            } else {
@@ -2287,9 +2894,20 @@ namespace snax {
 
    template<typename VerifierFunc>
    void net_plugin_impl::send_all( const net_message &msg, VerifierFunc verify) {
+      // serialize lazily, the verifier may reject every connection
+      broadcast_buffer buffer( msg );
+      for( auto &c : connections) {
+         if( c->current() && verify( c)) {
+            c->enqueue_buffer( buffer.get( *c ), true, false, no_reason );
+         }
+      }
+   }
+
+   template<typename VerifierFunc>
+   void net_plugin_impl::send_all( const send_buffer_ptr& send_buffer, VerifierFunc verify) {
       for( auto &c : connections) {
          if( c->current() && verify( c)) {
-            c->enqueue( msg );
+            c->enqueue_buffer( send_buffer, true, false, no_reason );
          }
       }
    }
@@ -2610,21 +3228,25 @@ namespace snax {
       }
       transaction_id_type tid = msg.id();
       c->cancel_wait();
+      ++c->trxs_received;
       if(local_txns.get<by_id>().find(tid) != local_txns.end()) {
          fc_dlog(logger, "got a duplicate transaction - dropping");
+         ++c->duplicate_trxs_received;
          return;
       }
       dispatcher->recv_transaction(c, tid);
-      c->trx_in_progress_size += calc_trx_size( msg );
-      chain_plug->accept_transaction(msg, [=](const static_variant<fc::exception_ptr, transaction_trace_ptr>& result) {
-         c->trx_in_progress_size -= calc_trx_size( msg );
+      const auto trx_size = calc_trx_size( msg );
+      c->trx_in_progress_size += trx_size;
+      auto ptrx = std::make_shared<packed_transaction>( msg );
+      chain_plug->accept_transaction(ptrx, [=](const static_variant<fc::exception_ptr, transaction_trace_ptr>& result) {
+         c->trx_in_progress_size -= trx_size;
          if (result.contains<fc::exception_ptr>()) {
             peer_dlog(c, "bad packed_transaction : ${m}", ("m",result.get<fc::exception_ptr>()->what()));
          } else {
             auto trace = result.get<transaction_trace_ptr>();
             if (!trace->except) {
                fc_dlog(logger, "chain accepted transaction");
-               dispatcher->bcast_transaction(msg);
+               dispatcher->bcast_transaction(*ptrx);
                return;
             }
 
@@ -2635,15 +3257,46 @@ namespace snax {
       });
    }
 
-   void net_plugin_impl::handle_message( connection_ptr c, const signed_block &msg) {
-      controller &cc = chain_plug->chain();
-      block_id_type blk_id = msg.id();
-      uint32_t blk_num = msg.block_num();
+   void net_plugin_impl::handle_message( connection_ptr c, const transaction_batch_message &msg) {
+      peer_dlog(c, "received transaction_batch_message of ${n} trxs", ("n", msg.transactions.size()));
+      if( chain_plug->chain().get_read_mode() == snax::db_read_mode::READ_ONLY ) {
+         fc_dlog(logger, "got a txn batch in read-only mode - dropping");
+         return;
+      }
+      if( sync_master->is_active(c) ) {
+         fc_dlog(logger, "got a txn batch during sync - dropping");
+         return;
+      }
+      for( const auto& trx : msg.transactions ) {
+         handle_message( c, trx );
+      }
+   }
+
+   void net_plugin_impl::handle_message( connection_ptr c, const signed_block &msg, const received_block_bytes* raw ) {
       fc_dlog(logger, "canceling wait on ${p}", ("p",c->peer_name()));
       c->cancel_wait();
+      if( sync_master->buffer_block( c, msg ) ) {
+         return;
+      }
+      process_block( c, msg, raw );
+
+      // blocks which arrived ahead of this one from other sync peers
+      connection_ptr from;
+      signed_block_ptr next;
+      while( sync_master->next_buffered_block( from, next ) ) {
+         process_block( from, *next );
+      }
+   }
+
+   void net_plugin_impl::process_block( connection_ptr c, const signed_block &msg, const received_block_bytes* raw ) {
+      controller &cc = chain_plug->chain();
+      block_id_type blk_id = raw ? raw->id : msg.id();
+      uint32_t blk_num = msg.block_num();
+      ++c->blocks_received;
 
       try {
          if( cc.fetch_block_by_id(blk_id)) {
+            ++c->duplicate_blocks_received;
             sync_master->recv_block(c, blk_id, blk_num);
             return;
          }
@@ -2656,6 +3309,24 @@ namespace snax {
       fc::microseconds age( fc::time_point::now() - msg.timestamp);
       peer_ilog(c, "received signed_block : #${n} block age in secs = ${age}",
               ("n",blk_num)("age",age.to_seconds()));
+      if( !sync_master->is_active(c) ) {
+         ++c->block_latency_samples;
+         c->block_latency_sum_us += age.count();
+         c->max_block_latency_us = std::max( c->max_block_latency_us, age.count() );
+
+         auto& prop = propagation[msg.producer];
+         prop.producer = msg.producer;
+         ++prop.blocks;
+         prop.last_delay_us = age.count();
+         prop.max_delay_us = std::max( prop.max_delay_us, age.count() );
+         prop.avg_delay_us += (age.count() - prop.avg_delay_us) / int64_t(prop.blocks);
+      }
+
+      // bcast_block relays the received bytes when it is signaled while the block is accepted
+      if( raw ) {
+         received_block_buffers[blk_id] = raw->bytes;
+      }
+      auto erase_raw = fc::make_scoped_exit( [&]() { received_block_buffers.erase( blk_id ); } );
 
       go_away_reason reason = fatal_other;
       try {
@@ -2689,10 +3360,6 @@ namespace snax {
             if( ltx != local_txns.end()) {
                local_txns.modify( ltx, ubn );
             }
-            auto ctx = c->trx_state.get<by_id>().find(id);
-            if( ctx != c->trx_state.end()) {
-               c->trx_state.modify( ctx, ubn );
-            }
          }
          sync_master->recv_block(c, blk_id, blk_num);
       }
@@ -2702,6 +3369,170 @@ namespace snax {
       }
    }
 
+   optional<compact_block_message> net_plugin_impl::make_compact_block( const signed_block& b, const connection& c ) {
+      compact_block_message msg;
+      msg.header = b;
+      msg.block_extensions = b.block_extensions;
+      msg.transactions.reserve( b.transactions.size() );
+      const auto& txns_by_id = local_txns.get<by_id>();
+      for( const auto& recpt : b.transactions ) {
+         msg.transactions.emplace_back( recpt );
+         if( recpt.trx.contains<packed_transaction>() ) {
+            auto id = recpt.trx.get<packed_transaction>().id();
+            // sent to or received from this peer, eliding anything else would cost it a round trip
+            if( c.known_trxs.contains( id ) && txns_by_id.find( id ) != txns_by_id.end() ) {
+               msg.transactions.back().trx = id;
+               msg.elided.push_back( msg.transactions.size() - 1 );
+            }
+         }
+      }
+      if( msg.elided.empty() )
+         return optional<compact_block_message>();
+      return msg;
+   }
+
+   void net_plugin_impl::handle_message( connection_ptr c, const compact_block_message &msg) {
+      auto block = std::make_shared<signed_block>();
+      static_cast<signed_block_header&>(*block) = msg.header;
+      block->transactions = msg.transactions;
+      block->block_extensions = msg.block_extensions;
+
+      block_id_type blk_id = block->id();
+      if( chain_plug->chain().fetch_block_by_id( blk_id ) ) {
+         handle_message( c, *block ); // known block, only the bookkeeping is needed
+         return;
+      }
+
+      // requests name the missing ones in this order, a peer answers only increasing indexes
+      SNAX_ASSERT( std::adjacent_find( msg.elided.begin(), msg.elided.end(), std::greater_equal<uint32_t>() ) == msg.elided.end(),
+                   plugin_exception, "elided transaction indexes of compact block ${id} are not increasing", ("id", blk_id) );
+
+      vector<uint32_t> missing;
+      const auto& txns_by_id = local_txns.get<by_id>();
+      for( auto index : msg.elided ) {
+         SNAX_ASSERT( index < block->transactions.size() && block->transactions[index].trx.contains<transaction_id_type>(),
+                      plugin_exception, "invalid elided transaction index ${i} in compact block ${id}", ("i", index)("id", blk_id) );
+         auto& recpt = block->transactions[index];
+         auto ltx = txns_by_id.find( recpt.trx.get<transaction_id_type>() );
+         if( ltx == txns_by_id.end() || !ltx->serialized_txn ) {
+            missing.push_back( index );
+            continue;
+         }
+         fc::datastream<const char*> ds( ltx->serialized_txn->data() + message_header_size,
+                                         ltx->serialized_txn->size() - message_header_size );
+         net_message trx_msg;
+         fc::raw::unpack( ds, trx_msg );
+         recpt.trx = std::move( trx_msg.get<packed_transaction>() );
+      }
+
+      if( missing.empty() ) {
+         accept_compact_block( c, block, msg.elided, false );
+         return;
+      }
+
+      peer_dlog( c, "compact block #${n} is missing ${m} of ${e} transactions, requesting them",
+                 ("n", block->block_num())("m", missing.size())("e", msg.elided.size()) );
+      request_compact_block_transactions( c, blk_id, block, msg.elided, std::move(missing) );
+   }
+
+   void net_plugin_impl::request_compact_block_transactions( connection_ptr c, const block_id_type& id,
+                                                             const signed_block_ptr& b, const vector<uint32_t>& elided,
+                                                             vector<uint32_t> missing ) {
+      // several compact blocks may be waiting on the same peer, drop the oldest beyond the limit
+      auto& pending = c->pending_compact_blocks;
+      if( pending.find( id ) == pending.end() && pending.size() >= def_max_pending_compact_blocks ) {
+         auto oldest = pending.begin();
+         for( auto it = pending.begin(); it != pending.end(); ++it ) {
+            if( it->second.block->block_num() < oldest->second.block->block_num() )
+               oldest = it;
+         }
+         pending.erase( oldest );
+      }
+      c->enqueue( get_block_transactions_message{ id, missing } );
+      pending[id] = connection::pending_compact_block{ b, elided, std::move(missing) };
+   }
+
+   void net_plugin_impl::accept_compact_block( connection_ptr c, const signed_block_ptr& b, const vector<uint32_t>& elided, bool all_from_peer ) {
+      // a local copy of a transaction may differ from the one in the block in what its id does not cover,
+      // e.g. its signatures, check before the block is validated and the peer blamed for it.
+      // once every elided transaction came from the peer a mismatch is the block's own, left to validation
+      if( !all_from_peer ) {
+         vector<digest_type> trx_digests;
+         trx_digests.reserve( b->transactions.size() );
+         for( const auto& recpt : b->transactions )
+            trx_digests.emplace_back( recpt.digest() );
+         if( merkle( std::move(trx_digests) ) != b->transaction_mroot ) {
+            peer_wlog( c, "compact block #${n} does not match its transaction merkle, requesting the elided transactions",
+                       ("n", b->block_num()) );
+            for( auto index : elided )
+               b->transactions[index].trx = b->transactions[index].trx.get<packed_transaction>().id();
+            request_compact_block_transactions( c, b->id(), b, elided, elided );
+            return;
+         }
+      }
+      handle_message( c, *b );
+   }
+
+   void net_plugin_impl::handle_message( connection_ptr c, const get_block_transactions_message &msg) {
+      signed_block_ptr block;
+      try {
+         block = chain_plug->chain().fetch_block_by_id( msg.block_id );
+      } FC_LOG_AND_DROP();
+      if( !block ) {
+         peer_wlog( c, "peer requested transactions of unknown block ${id}", ("id", msg.block_id) );
+         return;
+      }
+
+      // each transaction at most once, otherwise a small request could make the response arbitrarily large
+      if( msg.indexes.size() > block->transactions.size() ||
+          std::adjacent_find( msg.indexes.begin(), msg.indexes.end(), std::greater_equal<uint32_t>() ) != msg.indexes.end() ) {
+         peer_elog( c, "invalid request of ${n} transactions of block ${id}, closing connection",
+                    ("n", msg.indexes.size())("id", msg.block_id) );
+         close( c );
+         return;
+      }
+
+      block_transactions_message response;
+      response.block_id = msg.block_id;
+      response.transactions.reserve( msg.indexes.size() );
+      for( auto index : msg.indexes ) {
+         SNAX_ASSERT( index < block->transactions.size() && block->transactions[index].trx.contains<packed_transaction>(),
+                      plugin_exception, "invalid transaction index ${i} requested of block ${id}", ("i", index)("id", msg.block_id) );
+         response.transactions.emplace_back( block->transactions[index].trx.get<packed_transaction>() );
+      }
+      c->enqueue( response );
+   }
+
+   void net_plugin_impl::handle_message( connection_ptr c, const block_transactions_message &msg) {
+      auto pending = c->pending_compact_blocks.find( msg.block_id );
+      if( pending == c->pending_compact_blocks.end() ) {
+         peer_wlog( c, "received transactions of block ${id} which was not requested", ("id", msg.block_id) );
+         return;
+      }
+      auto block = std::move( pending->second.block );
+      auto elided = std::move( pending->second.elided );
+      auto missing = std::move( pending->second.missing );
+      c->pending_compact_blocks.erase( pending );
+
+      SNAX_ASSERT( msg.transactions.size() == missing.size(), plugin_exception,
+                   "received ${r} transactions of block ${id}, requested ${m}",
+                   ("r", msg.transactions.size())("id", msg.block_id)("m", missing.size()) );
+      for( size_t i = 0; i < missing.size(); ++i ) {
+         auto& recpt = block->transactions[missing[i]];
+         SNAX_ASSERT( msg.transactions[i].id() == recpt.trx.get<transaction_id_type>(), plugin_exception,
+                      "received transaction does not match the id in block ${id}", ("id", msg.block_id) );
+         recpt.trx = msg.transactions[i];
+      }
+      // local copies filled in the rest, they may still differ from the block's in what their ids do not cover
+      accept_compact_block( c, block, elided, missing.size() == elided.size() );
+   }
+
+   void net_plugin_impl::handle_message( connection_ptr c, const compressed_message &msg) {
+      auto inner = decompress_message( msg, c->compression );
+      msgHandler m( *this, c );
+      inner.visit( m );
+   }
+
    void net_plugin_impl::start_conn_timer(boost::asio::steady_timer::duration du, std::weak_ptr<connection> from_connection) {
       connector_check->expires_from_now( du);
       connector_check->async_wait( [this, from_connection](boost::system::error_code ec) {
@@ -2743,9 +3574,32 @@ namespace snax {
          });
    }
 
+   void net_plugin_impl::start_trx_batch_timer() {
+      if( trx_batch_timer_armed ) {
+         return;
+      }
+      trx_batch_timer_armed = true;
+      trx_batch_timer->expires_from_now( trx_batch_window );
+      trx_batch_timer->async_wait( [this](boost::system::error_code ec) {
+            trx_batch_timer_armed = false;
+            if( ec ) {
+               if( ec != boost::asio::error::operation_aborted ) {
+                  elog( "Error from transaction batch timer: ${m}",( "m", ec.message()));
+               }
+               return;
+            }
+            for( auto& c : connections ) {
+               if( c->current() ) {
+                  c->flush_trx_batch();
+               }
+            }
+         });
+   }
+
    void net_plugin_impl::start_monitors() {
       connector_check.reset(new boost::asio::steady_timer( app().get_io_service()));
       transaction_check.reset(new boost::asio::steady_timer( app().get_io_service()));
+      trx_batch_timer.reset(new boost::asio::steady_timer( app().get_io_service()));
       start_conn_timer(connector_period, std::weak_ptr<connection>());
       start_txn_timer();
    }
@@ -2763,10 +3617,6 @@ namespace snax {
       stale.erase( stale.lower_bound(1), stale.upper_bound(bn) );
       dispatcher->expire_blocks( bn );
       for ( auto &c : connections ) {
-         auto &stale_txn = c->trx_state.get<by_block_num>();
-         stale_txn.erase( stale_txn.lower_bound(1), stale_txn.upper_bound(bn) );
-         auto &stale_txn_e = c->trx_state.get<by_expiry>();
-         stale_txn_e.erase(stale_txn_e.lower_bound(time_point_sec()), stale_txn_e.upper_bound(time_point::now()));
          auto &stale_blk = c->blk_state.get<by_block_num>();
          stale_blk.erase( stale_blk.lower_bound(1), stale_blk.upper_bound(bn) );
       }
@@ -3000,8 +3850,19 @@ namespace snax {
          ( "network-version-match", bpo::value<bool>()->default_value(false),
            "True to require exact match of peer network version.")
          ( "sync-fetch-span", bpo::value<uint32_t>()->default_value(def_sync_fetch_span), "number of blocks to retrieve in a chunk from any individual peer during synchronization")
+         ( "sync-fetch-peers", bpo::value<uint32_t>()->default_value(def_sync_fetch_peers),
+           "number of peers to retrieve chunks from at the same time during synchronization, the chunk size of each peer adapts to its throughput")
          ( "max-implicit-request", bpo::value<uint32_t>()->default_value(def_max_just_send), "maximum sizes of transaction or block messages that are sent without first sending a notice")
          ( "use-socket-read-watermark", bpo::value<bool>()->default_value(false), "Enable expirimental socket read watermark optimization")
+         ( "p2p-compression", bpo::value<bool>()->default_value(false),
+           "Compress messages of at least 1KiB to peers that support it, e.g. blocks during sync. Received compressed messages are always accepted")
+         ( "p2p-compact-blocks", bpo::value<bool>()->default_value(true),
+           "Relay blocks to capable peers without the transactions already relayed to them, peers ask for any they miss")
+         ( "p2p-trx-batch-ms", bpo::value<uint32_t>()->default_value(def_trx_batch_window_ms),
+           "Milliseconds to collect relayed transactions for a peer that supports it before sending them as one message, 0 sends each one on its own")
+         ( "net-decode-threads", bpo::value<uint16_t>()->default_value(def_net_decode_threads),
+           "Number of threads decoding received p2p messages off the main thread, 0 decodes them on the main thread. "
+           "Socket reads and writes, handshakes and message handling stay on the main thread")
          ( "peer-log-format", bpo::value<string>()->default_value( "[\"${_name}\" ${_ip}:${_port}]" ),
            "The string used to format peers when logging messages about them.  Variables are escaped with ${<variable name>}.\n"
            "Available Variables:\n"
@@ -3027,7 +3888,8 @@ namespace snax {
 
          my->network_version_match = options.at( "network-version-match" ).as<bool>();
 
-         my->sync_master.reset( new sync_manager( options.at( "sync-fetch-span" ).as<uint32_t>()));
+         my->sync_master.reset( new sync_manager( options.at( "sync-fetch-span" ).as<uint32_t>(),
+                                                  options.at( "sync-fetch-peers" ).as<uint32_t>()));
          my->dispatcher.reset( new dispatch_manager );
 
          my->connector_period = std::chrono::seconds( options.at( "connection-cleanup-period" ).as<int>());
@@ -3041,6 +3903,13 @@ namespace snax {
          my->started_sessions = 0;
 
          my->use_socket_read_watermark = options.at( "use-socket-read-watermark" ).as<bool>();
+         my->compact_blocks = options.at( "p2p-compact-blocks" ).as<bool>();
+         my->compression = options.at( "p2p-compression" ).as<bool>();
+         my->trx_batch_window = std::chrono::milliseconds( options.at( "p2p-trx-batch-ms" ).as<uint32_t>() );
+
+         my->decode_threads = options.at( "net-decode-threads" ).as<uint16_t>();
+         if( my->decode_threads > 0 )
+            my->decode_pool.emplace( my->decode_threads );
 
          my->resolver = std::make_shared<tcp::resolver>( std::ref( app().get_io_service()));
          if( options.count( "p2p-listen-endpoint" )) {
@@ -3183,6 +4052,10 @@ namespace snax {
 
             my->acceptor.reset(nullptr);
          }
+         if( my->decode_pool ) {
+            my->decode_pool->join();
+            my->decode_pool->stop();
+         }
          ilog( "exit shutdown" );
       }
       FC_CAPTURE_AND_RETHROW()
@@ -3234,6 +4107,21 @@ namespace snax {
       }
       return result;
    }
+
+   network_telemetry net_plugin::telemetry()const {
+      network_telemetry result;
+      result.peers.reserve( my->connections.size() );
+      for( const auto& c : my->connections ) {
+         result.peers.push_back( c->get_telemetry() );
+         my->sync_master->peer_progress( c, result.peers.back() );
+      }
+      result.producers.reserve( my->propagation.size() );
+      for( const auto& p : my->propagation ) {
+         result.producers.push_back( p.second );
+      }
+      result.sync = my->sync_master->progress();
+      return result;
+   }
    connection_ptr net_plugin_impl::find_connection( string host )const {
       for( const auto& c : connections )
          if( c->peer_addr == host ) return c;
@@ -90,6 +90,8 @@ void producer_api_plugin::plugin_startup() {
             INVOKE_R_V(producer, get_integrity_hash), 201),
        CALL(producer, producer, create_snapshot,
             INVOKE_R_V(producer, create_snapshot), 201),
+       CALL(producer, producer, get_incoming_queue_stats,
+            INVOKE_R_R(producer, get_incoming_queue_stats, producer_plugin::incoming_queue_stats_params), 201),
    });
 }
 
@@ -51,6 +51,27 @@ public:
       std::string          snapshot_name;
    };
 
+   struct incoming_queue_stats_params {
+      uint32_t top_accounts = 20;
+   };
+
+   struct incoming_queue_account {
+      account_name   account;
+      uint32_t       queued = 0;
+      uint64_t       bytes  = 0;
+      double         share  = 0; ///< of all queued bytes
+   };
+
+   struct incoming_queue_stats {
+      uint64_t                        size = 0;
+      uint64_t                        bytes = 0;
+      uint64_t                        max_bytes = 0;
+      uint64_t                        priority_size = 0;
+      uint64_t                        evicted = 0;    ///< since startup
+      uint64_t                        accounts = 0;   ///< accounts with queued transactions
+      vector<incoming_queue_account>  top_accounts;   ///< by queued bytes
+   };
+
    producer_plugin();
    virtual ~producer_plugin();
 
@@ -80,6 +101,7 @@ public:
    void set_whitelist_blacklist(const whitelist_blacklist& params);
 
    integrity_hash_information get_integrity_hash() const;
+   incoming_queue_stats get_incoming_queue_stats(const incoming_queue_stats_params& params) const;
    snapshot_information create_snapshot() const;
 
    signal<void(const chain::producer_confirmation&)> confirmed_block;
@@ -94,4 +116,7 @@ FC_REFLECT(snax::producer_plugin::greylist_params, (accounts));
 FC_REFLECT(snax::producer_plugin::whitelist_blacklist, (actor_whitelist)(actor_blacklist)(contract_whitelist)(contract_blacklist)(action_blacklist)(key_blacklist) )
 FC_REFLECT(snax::producer_plugin::integrity_hash_information, (head_block_id)(integrity_hash))
 FC_REFLECT(snax::producer_plugin::snapshot_information, (head_block_id)(snapshot_name))
+FC_REFLECT(snax::producer_plugin::incoming_queue_stats_params, (top_accounts))
+FC_REFLECT(snax::producer_plugin::incoming_queue_account, (account)(queued)(bytes)(share))
+FC_REFLECT(snax::producer_plugin::incoming_queue_stats, (size)(bytes)(max_bytes)(priority_size)(evicted)(accounts)(top_accounts))
 
@@ -15,6 +15,7 @@
 #include <fc/scoped_exit.hpp>
 
 #include <boost/asio.hpp>
+#include <boost/asio/thread_pool.hpp>
 #include <boost/date_time/posix_time/posix_time.hpp>
 
 #include <iostream>
@@ -90,6 +91,144 @@ enum class pending_block_mode {
    producing,
    speculating
 };
+
+/**
+ *  Incoming transactions waiting to be applied, served by deficit round robin over their first authorizer so
+ *  that one busy account cannot starve the others. Transactions of priority accounts are served first, in
+ *  arrival order. The queue is bounded by the packed size of what it holds: when a push does not fit, the newest
+ *  transactions of the account holding the most bytes are evicted, which may be the pushed one itself.
+ */
+class incoming_transaction_queue {
+   public:
+      struct entry {
+         packed_transaction_ptr                trx;
+         transaction_metadata_ptr              mtrx;
+         bool                                  persist_until_expired = false;
+         next_function<transaction_trace_ptr>  next;
+         account_name                          account;
+         uint64_t                              size = 0;
+      };
+
+      /// bytes an account may be served per round, transactions larger than this wait for several rounds
+      static constexpr uint64_t quantum = 8 * 1024;
+
+      void set_max_bytes( uint64_t max_bytes ) { _max_bytes = max_bytes; }
+      void set_priority_accounts( flat_set<account_name> accounts ) { _priority_accounts = std::move(accounts); }
+
+      /// @return the transactions evicted to make room, their callers still need a response
+      vector<entry> push( const packed_transaction_ptr& trx, const transaction_metadata_ptr& mtrx,
+                          bool persist_until_expired, next_function<transaction_trace_ptr> next ) {
+         entry e{ trx, mtrx, persist_until_expired, std::move(next) };
+         e.account = mtrx ? mtrx->trx.first_authorizor() : account_name();
+         e.size = trx->get_unprunable_size() + trx->get_prunable_size();
+
+         _bytes += e.size;
+         ++_size;
+         if( _priority_accounts.count( e.account ) ) {
+            _priority.emplace_back( std::move(e) );
+         } else {
+            auto& q = _accounts[e.account];
+            if( q.trxs.empty() )
+               _round.push_back( e.account );
+            q.bytes += e.size;
+            q.trxs.emplace_back( std::move(e) );
+         }
+
+         vector<entry> evicted;
+         while( _bytes > _max_bytes && !_accounts.empty() ) {
+            auto heaviest = std::max_element( _accounts.begin(), _accounts.end(), []( const auto& l, const auto& r ) {
+               return l.second.bytes < r.second.bytes;
+            });
+            evicted.emplace_back( std::move(heaviest->second.trxs.back()) );
+            heaviest->second.trxs.pop_back();
+            heaviest->second.bytes -= evicted.back().size;
+            remove_bytes( evicted.back().size );
+            if( heaviest->second.trxs.empty() ) {
+               _round.erase( std::find( _round.begin(), _round.end(), heaviest->first ) );
+               _accounts.erase( heaviest );
+            }
+         }
+         _evicted += evicted.size();
+         return evicted;
+      }
+
+      entry pop() {
+         FC_ASSERT( !empty(), "incoming transaction queue is empty" );
+         if( !_priority.empty() ) {
+            auto e = std::move( _priority.front() );
+            _priority.pop_front();
+            remove_bytes( e.size );
+            return e;
+         }
+
+         while( true ) {
+            auto itr = _accounts.find( _round.front() );
+            auto& q = itr->second;
+            if( q.deficit < q.trxs.front().size ) {
+               q.deficit += quantum;
+               _round.push_back( _round.front() );
+               _round.pop_front();
+               continue;
+            }
+
+            auto e = std::move( q.trxs.front() );
+            q.trxs.pop_front();
+            q.deficit -= e.size;
+            q.bytes -= e.size;
+            remove_bytes( e.size );
+            if( q.trxs.empty() ) {
+               _round.pop_front();
+               _accounts.erase( itr );
+            }
+            return e;
+         }
+      }
+
+      bool     empty()const { return _size == 0; }
+      size_t   size()const  { return _size; }
+
+      producer_plugin::incoming_queue_stats get_stats( uint32_t top_accounts )const {
+         producer_plugin::incoming_queue_stats result;
+         result.size           = _size;
+         result.bytes          = _bytes;
+         result.max_bytes      = _max_bytes;
+         result.priority_size  = _priority.size();
+         result.evicted        = _evicted;
+         result.accounts       = _accounts.size();
+
+         result.top_accounts.reserve( _accounts.size() );
+         for( const auto& a : _accounts )
+            result.top_accounts.push_back( { a.first, static_cast<uint32_t>(a.second.trxs.size()), a.second.bytes,
+                                             _bytes ? double(a.second.bytes) / _bytes : 0.0 } );
+         auto mid = result.top_accounts.begin() + std::min<size_t>( top_accounts, result.top_accounts.size() );
+         std::partial_sort( result.top_accounts.begin(), mid, result.top_accounts.end(), []( const auto& l, const auto& r ) {
+            return l.bytes > r.bytes;
+         });
+         result.top_accounts.erase( mid, result.top_accounts.end() );
+         return result;
+      }
+
+   private:
+      struct account_queue {
+         deque<entry>  trxs;
+         uint64_t      bytes   = 0;
+         uint64_t      deficit = 0;
+      };
+
+      void remove_bytes( uint64_t size ) {
+         _bytes -= size;
+         --_size;
+      }
+
+      uint64_t                             _max_bytes = std::numeric_limits<uint64_t>::max();
+      flat_set<account_name>               _priority_accounts;
+      deque<entry>                         _priority;
+      std::map<account_name, account_queue> _accounts;
+      deque<account_name>                  _round;   ///< accounts with queued transactions, in serving order
+      uint64_t                             _bytes = 0;
+      size_t                               _size = 0;
+      uint64_t                             _evicted = 0;
+};
 #define CATCH_AND_CALL(NEXT)\
    catch ( const fc::exception& err ) {\
       NEXT(err.dynamic_copy_exception());\
@@ -109,6 +248,8 @@ enum class pending_block_mode {
 
 class producer_plugin_impl : public std::enable_shared_from_this<producer_plugin_impl> {
    public:
+      using signature_provider_type = std::function<chain::signature_type(chain::digest_type)>;
+
       producer_plugin_impl(boost::asio::io_service& io)
       :_timer(io)
       ,_transaction_ack_channel(app().get_channel<compat::channels::transaction_ack>())
@@ -119,18 +260,19 @@ class producer_plugin_impl : public std::enable_shared_from_this<producer_plugin
       void schedule_production_loop();
       void produce_block();
       bool maybe_produce_block();
+      void sign_block_async(const block_state_ptr& pbs, const signature_provider_type& signature_provider);
+      void commit_produced_block();
 
       boost::program_options::variables_map _options;
       bool     _production_enabled                 = false;
       bool     _pause_production                   = false;
       uint32_t _production_skip_flags              = 0; //snax::chain::skip_nothing;
 
-      using signature_provider_type = std::function<chain::signature_type(chain::digest_type)>;
       std::map<chain::public_key_type, signature_provider_type> _signature_providers;
       std::set<chain::account_name>                             _producers;
       boost::asio::deadline_timer                               _timer;
       std::map<chain::account_name, uint32_t>                   _producer_watermarks;
-      pending_block_mode                                        _pending_block_mode;
+      pending_block_mode                                        _pending_block_mode = pending_block_mode::speculating;
       transaction_id_with_expiry_index                          _persistent_transactions;
 
       int32_t                                                   _max_transaction_time_ms;
@@ -140,6 +282,16 @@ class producer_plugin_impl : public std::enable_shared_from_this<producer_plugin
       int32_t                                                   _max_scheduled_transaction_time_per_block_ms;
       fc::time_point                                            _irreversible_block_time;
       fc::microseconds                                          _kxd_provider_timeout_us;
+      bool                                                      _async_block_signing = false;
+      bool                                                      _skip_speculative_reapply = false;
+      block_id_type                                             _speculative_reapply_head; ///< head all persisted transactions were last re-executed on
+
+      // while a finalized block is being signed on the thread pool, blocks received are held back
+      // and transactions are queued, nothing may touch the pending block until it is committed
+      bool                                                      _signing_block = false;
+      vector<signed_block_ptr>                                  _blocks_received_while_signing;
+      // a thread of its own, so the block digest never waits behind key recoveries on the chain thread pool
+      fc::optional<boost::asio::thread_pool>                    _signing_thread;
 
       time_point _last_signed_block_time;
       time_point _start_time = fc::time_point::now();
@@ -287,6 +439,11 @@ class producer_plugin_impl : public std::enable_shared_from_this<producer_plugin
       };
 
       void on_incoming_block(const signed_block_ptr& block) {
+         if( _signing_block ) {
+            _blocks_received_while_signing.emplace_back( block );
+            return;
+         }
+
          auto id = block->id();
 
          fc_dlog(_log, "received incoming block ${id}", ("id", id));
@@ -344,18 +501,114 @@ class producer_plugin_impl : public std::enable_shared_from_this<producer_plugin
          }
       }
 
-      std::deque<std::tuple<packed_transaction_ptr, bool, next_function<transaction_trace_ptr>>> _pending_incoming_transactions;
+      incoming_transaction_queue _pending_incoming_transactions;
+
+      void queue_incoming_transaction(const packed_transaction_ptr& trx, const transaction_metadata_ptr& mtrx, bool persist_until_expired, next_function<transaction_trace_ptr> next) {
+         auto evicted = _pending_incoming_transactions.push(trx, mtrx, persist_until_expired, std::move(next));
+         for( auto& e : evicted ) {
+            fc_dlog(_trx_trace_log, "[TRX_TRACE] Incoming transaction queue is full, EVICTING tx from ${account}",
+                    ("account", e.account));
+            auto except = std::static_pointer_cast<fc::exception>(std::make_shared<incoming_queue_full_exception>(
+                  FC_LOG_MESSAGE(error, "incoming transaction queue is full, transaction from ${account} dropped", ("account", e.account))));
+            e.next(except);
+            _transaction_ack_channel.publish(std::pair<fc::exception_ptr, packed_transaction_ptr>(except, e.trx));
+         }
+      }
+
+      void process_pending_incoming_transaction() {
+         auto e = _pending_incoming_transactions.pop();
+         process_incoming_transaction(e.trx, e.mtrx, e.persist_until_expired, e.next);
+      }
+
+      struct recovering_transaction {
+         packed_transaction_ptr                  trx;
+         transaction_metadata_ptr                mtrx;
+         bool                                    persist_until_expired = false;
+         next_function<transaction_trace_ptr>    next;
+         bool                                    recovered = false;
+      };
 
+      /// incoming transactions in arrival order, processed from the front once their keys are recovered
+      deque<std::shared_ptr<recovering_transaction>>   _recovering_transactions;
+      uint32_t _pending_signature_recoveries = 0;
+      uint32_t _max_pending_signature_recoveries = 0;
+
+      /**
+       *  Unpacks the transaction and recovers its keys on the controller thread pool, then continues on the
+       *  main thread. Transactions are processed in the order they arrived whichever recovery finishes first,
+       *  so one depending on an earlier one from the same client still sees it applied. When too many
+       *  recoveries are already in flight the work is done inline instead, which slows down the main thread
+       *  and with it the net and http handlers feeding transactions in.
+       */
       void on_incoming_transaction_async(const packed_transaction_ptr& trx, bool persist_until_expired, next_function<transaction_trace_ptr> next) {
          chain::controller& chain = app().get_plugin<chain_plugin>().chain();
-         if (!chain.pending_block_state()) {
-            _pending_incoming_transactions.emplace_back(trx, persist_until_expired, next);
+         const auto chain_id = chain.get_chain_id();
+
+         auto prepare = [trx, chain_id]() -> transaction_metadata_ptr {
+            try {
+               auto mtrx = std::make_shared<transaction_metadata>( trx );
+               try {
+                  mtrx->recover_keys( chain_id );
+               } catch( ... ) {
+                  // recovery failures are reported when the transaction is pushed
+               }
+               return mtrx;
+            } catch( ... ) {
+               // unpack failures are reported by process_incoming_transaction
+            }
+            return nullptr;
+         };
+
+         auto entry = std::make_shared<recovering_transaction>();
+         entry->trx = trx;
+         entry->persist_until_expired = persist_until_expired;
+         entry->next = std::move(next);
+         _recovering_transactions.push_back( entry );
+
+         if( _pending_signature_recoveries >= _max_pending_signature_recoveries ) {
+            entry->mtrx = prepare();
+            entry->recovered = true;
+            process_recovered_transactions();
+            return;
+         }
+
+         ++_pending_signature_recoveries;
+         boost::asio::post( chain.get_thread_pool(), [this, entry, prepare]() {
+            auto mtrx = prepare();
+            app().get_io_service().post( [this, entry, mtrx]() {
+               --_pending_signature_recoveries;
+               entry->mtrx = mtrx;
+               entry->recovered = true;
+               process_recovered_transactions();
+            });
+         });
+      }
+
+      void process_recovered_transactions() {
+         while( !_recovering_transactions.empty() && _recovering_transactions.front()->recovered ) {
+            auto entry = std::move( _recovering_transactions.front() );
+            _recovering_transactions.pop_front();
+            try {
+               process_incoming_transaction( entry->trx, entry->mtrx, entry->persist_until_expired, entry->next );
+            } FC_LOG_AND_DROP();
+         }
+      }
+
+      void process_incoming_transaction(const packed_transaction_ptr& trx, transaction_metadata_ptr mtrx, bool persist_until_expired, next_function<transaction_trace_ptr> next) {
+         chain::controller& chain = app().get_plugin<chain_plugin>().chain();
+         if (!chain.pending_block_state() || _signing_block) {
+            queue_incoming_transaction(trx, mtrx, persist_until_expired, next);
             return;
          }
 
          auto block_time = chain.pending_block_state()->header.timestamp.to_time_point();
 
-         auto send_response = [this, &trx, &chain, &next](const fc::static_variant<fc::exception_ptr, transaction_trace_ptr>& response) {
+         // the metadata shares trx and holds the only unpacked copy, use it for id and expiration
+         if( !mtrx )
+            mtrx = std::make_shared<transaction_metadata>(trx);
+         const auto& id = mtrx->id;
+
+         auto send_response = [this, &trx, &id, &chain, &next](const fc::static_variant<fc::exception_ptr, transaction_trace_ptr>& response) {
             next(response);
             if (response.contains<fc::exception_ptr>()) {
                _transaction_ack_channel.publish(std::pair<fc::exception_ptr, packed_transaction_ptr>(response.get<fc::exception_ptr>(), trx));
@@ -363,11 +616,11 @@ class producer_plugin_impl : public std::enable_shared_from_this<producer_plugin
                   fc_dlog(_trx_trace_log, "[TRX_TRACE] Block ${block_num} for producer ${prod} is REJECTING tx: ${txid} : ${why} ",
                         ("block_num", chain.head_block_num() + 1)
                         ("prod", chain.pending_block_state()->header.producer)
-                        ("txid", trx->id())
+                        ("txid", id)
                         ("why",response.get<fc::exception_ptr>()->what()));
                } else {
                   fc_dlog(_trx_trace_log, "[TRX_TRACE] Speculative execution is REJECTING tx: ${txid} : ${why} ",
-                          ("txid", trx->id())
+                          ("txid", id)
                           ("why",response.get<fc::exception_ptr>()->what()));
                }
             } else {
@@ -376,16 +629,15 @@ class producer_plugin_impl : public std::enable_shared_from_this<producer_plugin
                   fc_dlog(_trx_trace_log, "[TRX_TRACE] Block ${block_num} for producer ${prod} is ACCEPTING tx: ${txid}",
                           ("block_num", chain.head_block_num() + 1)
                           ("prod", chain.pending_block_state()->header.producer)
-                          ("txid", trx->id()));
+                          ("txid", id));
                } else {
                   fc_dlog(_trx_trace_log, "[TRX_TRACE] Speculative execution is ACCEPTING tx: ${txid}",
-                          ("txid", trx->id()));
+                          ("txid", id));
                }
             }
          };
 
-         auto id = trx->id();
-         if( fc::time_point(trx->expiration()) < block_time ) {
+         if( fc::time_point(mtrx->trx.expiration) < block_time ) {
             send_response(std::static_pointer_cast<fc::exception>(std::make_shared<expired_tx_exception>(FC_LOG_MESSAGE(error, "expired transaction ${id}", ("id", id)) )));
             return;
          }
@@ -404,18 +656,18 @@ class producer_plugin_impl : public std::enable_shared_from_this<producer_plugin
          }
 
          try {
-            auto trace = chain.push_transaction(std::make_shared<transaction_metadata>(*trx), deadline);
+            auto trace = chain.push_transaction(mtrx, deadline);
             if (trace->except) {
                if (failure_is_subjective(*trace->except, deadline_is_subjective)) {
-                  _pending_incoming_transactions.emplace_back(trx, persist_until_expired, next);
+                  queue_incoming_transaction(trx, mtrx, persist_until_expired, next);
                   if (_pending_block_mode == pending_block_mode::producing) {
                      fc_dlog(_trx_trace_log, "[TRX_TRACE] Block ${block_num} for producer ${prod} COULD NOT FIT, tx: ${txid} RETRYING ",
                              ("block_num", chain.head_block_num() + 1)
                              ("prod", chain.pending_block_state()->header.producer)
-                             ("txid", trx->id()));
+                             ("txid", id));
                   } else {
                      fc_dlog(_trx_trace_log, "[TRX_TRACE] Speculative execution COULD NOT FIT tx: ${txid} RETRYING",
-                             ("txid", trx->id()));
+                             ("txid", id));
                   }
                } else {
                   auto e_ptr = trace->except->dynamic_copy_exception();
@@ -425,7 +677,7 @@ class producer_plugin_impl : public std::enable_shared_from_this<producer_plugin
                if (persist_until_expired) {
                   // if this trx didnt fail/soft-fail and the persist flag is set, store its ID so that we can
                   // ensure its applied to all future speculative blocks as well.
-                  _persistent_transactions.insert(transaction_id_with_expiry{trx->id(), trx->expiration()});
+                  _persistent_transactions.insert(transaction_id_with_expiry{id, mtrx->trx.expiration});
                }
                send_response(trace);
             }
@@ -524,6 +776,10 @@ void producer_plugin::set_program_options(
           "   KXD:<data>    \tis the URL where kxd is available and the approptiate wallet(s) are unlocked")
          ("kxd-provider-timeout", boost::program_options::value<int32_t>()->default_value(5),
           "Limits the maximum time (in milliseconds) that is allowd for sending blocks to a kxd provider for signing")
+         ("skip-speculative-reapply", boost::program_options::bool_switch()->default_value(false),
+          "While speculating, re-execute persisted transactions only once per head block instead of every time the speculative block is restarted, e.g. for a new slot on the same head. Saves CPU on API nodes, but until the next head block the restarted pending state does not reflect them")
+         ("async-block-signing", boost::program_options::bool_switch()->default_value(false),
+          "Sign produced blocks on a dedicated thread so the main thread keeps serving net and http while a (possibly remote) signature provider runs")
          ("greylist-account", boost::program_options::value<vector<string>>()->composing()->multitoken(),
           "account that can not access to extended CPU/NET virtual resources")
          ("produce-time-offset-us", boost::program_options::value<int32_t>()->default_value(0),
@@ -534,6 +790,12 @@ void producer_plugin::set_program_options(
           "Maximum wall-clock time, in milliseconds, spent retiring scheduled transactions in any block before returning to normal transaction processing.")
          ("incoming-defer-ratio", bpo::value<double>()->default_value(1.0),
           "ratio between incoming transations and deferred transactions when both are exhausted")
+         ("incoming-transaction-queue-size-mb", bpo::value<uint64_t>()->default_value(1024),
+          "Maximum size (in MiB) of the incoming transaction queue; when exceeded, the newest transactions of the account holding the most queued bytes are dropped")
+         ("priority-account", boost::program_options::value<vector<string>>()->composing()->multitoken(),
+          "Account (first authorizer) whose incoming transactions are applied ahead of the fairly scheduled ones (may specify multiple times)")
+         ("max-pending-signature-recoveries", bpo::value<uint32_t>()->default_value(1000),
+          "Maximum number of incoming transactions being unpacked and key-recovered on the chain thread pool at once; beyond this, incoming transactions are processed on the main thread")
          ("snapshots-dir", bpo::value<bfs::path>()->default_value("snapshots"),
           "the location of the snapshots directory (absolute path or relative to application data dir)")
          ;
@@ -654,6 +916,9 @@ void producer_plugin::plugin_initialize(const boost::program_options::variables_
 
    my->_kxd_provider_timeout_us = fc::milliseconds(options.at("kxd-provider-timeout").as<int32_t>());
 
+   my->_async_block_signing = options.at("async-block-signing").as<bool>();
+   my->_skip_speculative_reapply = options.at("skip-speculative-reapply").as<bool>();
+
    my->_produce_time_offset_us = options.at("produce-time-offset-us").as<int32_t>();
 
    my->_last_block_time_offset_us = options.at("last-block-time-offset-us").as<int32_t>();
@@ -666,6 +931,17 @@ void producer_plugin::plugin_initialize(const boost::program_options::variables_
 
    my->_incoming_defer_ratio = options.at("incoming-defer-ratio").as<double>();
 
+   my->_max_pending_signature_recoveries = options.at("max-pending-signature-recoveries").as<uint32_t>();
+
+   my->_pending_incoming_transactions.set_max_bytes( options.at("incoming-transaction-queue-size-mb").as<uint64_t>() * 1024 * 1024 );
+
+   if( options.count("priority-account") ) {
+      flat_set<account_name> priority_accounts;
+      for( const auto& a : options["priority-account"].as<std::vector<std::string>>() )
+         priority_accounts.insert( account_name(a) );
+      my->_pending_incoming_transactions.set_priority_accounts( std::move(priority_accounts) );
+   }
+
    if( options.count( "snapshots-dir" )) {
       auto sd = options.at( "snapshots-dir" ).as<bfs::path>();
       if( sd.is_relative()) {
@@ -755,6 +1031,10 @@ void producer_plugin::plugin_startup()
       }
    }
 
+   if (my->_async_block_signing) {
+      my->_signing_thread.emplace( 1 );
+   }
+
    my->schedule_production_loop();
 
    ilog("producer plugin:  plugin_startup() end");
@@ -769,6 +1049,11 @@ void producer_plugin::plugin_shutdown() {
 
    my->_accepted_block_connection.reset();
    my->_irreversible_block_connection.reset();
+
+   if (my->_signing_thread) {
+      my->_signing_thread->join();
+      my->_signing_thread->stop();
+   }
 }
 
 void producer_plugin::pause() {
@@ -855,6 +1140,10 @@ void producer_plugin::remove_greylist_accounts(const greylist_params& params) {
    }
 }
 
+producer_plugin::incoming_queue_stats producer_plugin::get_incoming_queue_stats(const incoming_queue_stats_params& params) const {
+   return my->_pending_incoming_transactions.get_stats( params.top_accounts );
+}
+
 producer_plugin::greylist_params producer_plugin::get_greylist() const {
    chain::controller& chain = app().get_plugin<chain_plugin>().chain();
    greylist_params result;
@@ -1031,6 +1320,7 @@ producer_plugin_impl::start_block_result producer_plugin_impl::start_block() {
    const fc::time_point now = fc::time_point::now();
    const fc::time_point block_time = calculate_pending_block_time();
 
+   const auto previous_block_mode = _pending_block_mode;
    _pending_block_mode = pending_block_mode::producing;
 
    // Not our turn
@@ -1092,8 +1382,16 @@ producer_plugin_impl::start_block_result producer_plugin_impl::start_block() {
          }
       }
 
-      chain.abort_block();
-      chain.start_block(block_time, blocks_to_confirm);
+      // a speculative block for the same head and slot would be rebuilt identically, keep it and only
+      // apply what arrived since
+      const auto& current_pbs = chain.pending_block_state();
+      if (_pending_block_mode == pending_block_mode::speculating && previous_block_mode == pending_block_mode::speculating &&
+          current_pbs && current_pbs->header.previous == hbs->id && current_pbs->header.timestamp.to_time_point() == block_time) {
+         fc_dlog(_log, "Keeping speculative block #${n} on unchanged head", ("n", current_pbs->block_num));
+      } else {
+         chain.abort_block();
+         chain.start_block(block_time, blocks_to_confirm);
+      }
    } FC_LOG_AND_DROP();
 
    const auto& pbs = chain.pending_block_state();
@@ -1163,8 +1461,12 @@ producer_plugin_impl::start_block_result producer_plugin_impl::start_block() {
                int num_applied = 0;
                int num_failed = 0;
                int num_processed = 0;
+               int num_skipped = 0;
+               // they were all validated against this very head already, the outcome could not differ
+               const bool skip_persisted = _skip_speculative_reapply && _pending_block_mode == pending_block_mode::speculating &&
+                                           _speculative_reapply_head == chain.head_block_id();
                auto calculate_transaction_category = [&](const transaction_metadata_ptr& trx) {
-                  if (trx->packed_trx.expiration() < pbs->header.timestamp.to_time_point()) {
+                  if (trx->trx.expiration < pbs->header.timestamp.to_time_point()) {
                      return tx_category::EXPIRED;
                   } else if (persisted_by_id.find(trx->id) != persisted_by_id.end()) {
                      return tx_category::PERSISTED;
@@ -1191,6 +1493,8 @@ producer_plugin_impl::start_block_result producer_plugin_impl::start_block() {
                      }
                      itr = unapplied_trxs.erase( itr ); // unapplied_trxs map has not been modified, so simply erase and continue
                      continue;
+                  } else if (category == tx_category::PERSISTED && skip_persisted) {
+                     ++num_skipped;
                   } else if (category == tx_category::PERSISTED ||
                             (category == tx_category::UNEXPIRED_UNPERSISTED && _pending_block_mode == pending_block_mode::producing))
                   {
@@ -1227,11 +1531,15 @@ producer_plugin_impl::start_block_result producer_plugin_impl::start_block() {
                   itr = itr_next;
                }
 
-               fc_dlog(_log, "Processed ${m} of ${n} previously applied transactions, Applied ${applied}, Failed/Dropped ${failed}",
+               if (_pending_block_mode == pending_block_mode::speculating && !skip_persisted && !exhausted)
+                  _speculative_reapply_head = chain.head_block_id();
+
+               fc_dlog(_log, "Processed ${m} of ${n} previously applied transactions, Applied ${applied}, Failed/Dropped ${failed}, Skipped ${skipped}",
                              ("m", num_processed)
                              ("n", unapplied_trxs_size)
                              ("applied", num_applied)
-                             ("failed", num_failed));
+                             ("failed", num_failed)
+                             ("skipped", num_skipped));
             }
          }
 
@@ -1298,11 +1606,9 @@ producer_plugin_impl::start_block_result producer_plugin_impl::start_block() {
                while (_incoming_trx_weight >= 1.0 && orig_pending_txn_size && _pending_incoming_transactions.size()) {
                   if (scheduled_trx_deadline <= fc::time_point::now()) break;
 
-                  auto e = _pending_incoming_transactions.front();
-                  _pending_incoming_transactions.pop_front();
                   --orig_pending_txn_size;
                   _incoming_trx_weight -= 1.0;
-                  on_incoming_transaction_async(std::get<0>(e), std::get<1>(e), std::get<2>(e));
+                  process_pending_incoming_transaction();
                }
 
                if (scheduled_trx_deadline <= fc::time_point::now()) {
@@ -1365,10 +1671,8 @@ producer_plugin_impl::start_block_result producer_plugin_impl::start_block() {
                fc_dlog(_log, "Processing ${n} pending transactions");
                while (orig_pending_txn_size && _pending_incoming_transactions.size()) {
                   if (preprocess_deadline <= fc::time_point::now()) return start_block_result::exhausted;
-                  auto e = _pending_incoming_transactions.front();
-                  _pending_incoming_transactions.pop_front();
                   --orig_pending_txn_size;
-                  on_incoming_transaction_async(std::get<0>(e), std::get<1>(e), std::get<2>(e));
+                  process_pending_incoming_transaction();
                }
             }
             return start_block_result::succeeded;
@@ -1385,6 +1689,9 @@ producer_plugin_impl::start_block_result producer_plugin_impl::start_block() {
 }
 
 void producer_plugin_impl::schedule_production_loop() {
+   // resumed once the block being signed is committed
+   if (_signing_block) return;
+
    chain::controller& chain = app().get_plugin<chain_plugin>().chain();
    _timer.cancel();
    std::weak_ptr<producer_plugin_impl> weak_this = shared_from_this();
@@ -1494,6 +1801,7 @@ bool producer_plugin_impl::maybe_produce_block() {
    try {
       try {
          produce_block();
+         if (_signing_block) reschedule.cancel();
          return true;
       } catch ( const guard_exception& e ) {
          app().get_plugin<chain_plugin>().handle_guard_exception(e);
@@ -1538,11 +1846,78 @@ void producer_plugin_impl::produce_block() {
 
    //idump( (fc::time_point::now() - chain.pending_block_time()) );
    chain.finalize_block();
+
+   if (_async_block_signing) {
+      sign_block_async(pbs, signature_provider_itr->second);
+      return;
+   }
+
    chain.sign_block( [&]( const digest_type& d ) {
       auto debug_logger = maybe_make_debug_time_logger();
       return signature_provider_itr->second(d);
    } );
 
+   commit_produced_block();
+}
+
+void producer_plugin_impl::sign_block_async(const block_state_ptr& pbs, const signature_provider_type& signature_provider) {
+   const auto digest = pbs->sig_digest();
+   std::weak_ptr<producer_plugin_impl> weak_this = shared_from_this();
+
+   _signing_block = true;
+   boost::asio::post( *_signing_thread, [weak_this, pbs, digest, signature_provider]() {
+      fc::optional<signature_type> sig;
+      try {
+         auto debug_logger = maybe_make_debug_time_logger();
+         sig = signature_provider(digest);
+      } FC_LOG_AND_DROP();
+
+      app().get_io_service().post( [weak_this, pbs, sig]() {
+         auto self = weak_this.lock();
+         if (!self) return;
+
+         chain::controller& chain = app().get_plugin<chain_plugin>().chain();
+         self->_signing_block = false;
+         auto blocks = std::move(self->_blocks_received_while_signing);
+         self->_blocks_received_while_signing.clear();
+
+         auto reschedule = fc::make_scoped_exit([self]{
+            self->schedule_production_loop();
+         });
+
+         // the pending block may have been aborted meanwhile, e.g. by pause or update_runtime_options
+         if (chain.pending_block_state() != pbs) {
+            wlog("Pending block #${n} was aborted while being signed, dropping it", ("n", pbs->block_num));
+         } else {
+            try {
+               try {
+                  SNAX_ASSERT(sig, producer_exception, "Signature provider failed to sign block #${n}", ("n", pbs->block_num));
+                  chain.sign_block( [&]( const digest_type& ) { return *sig; } );
+                  self->commit_produced_block();
+               } catch ( const guard_exception& e ) {
+                  app().get_plugin<chain_plugin>().handle_guard_exception(e);
+                  chain.abort_block();
+               } catch ( const fc::exception& e ) {
+                  elog("Aborting block #${n} after signing: ${e}", ("n", pbs->block_num)("e", e.to_detail_string()));
+                  chain.abort_block();
+               }
+            } catch ( boost::interprocess::bad_alloc& ) {
+               raise(SIGUSR1);
+               return;
+            }
+         }
+
+         for (const auto& b : blocks) {
+            try {
+               self->on_incoming_block(b);
+            } FC_LOG_AND_DROP();
+         }
+      });
+   });
+}
+
+void producer_plugin_impl::commit_produced_block() {
+   chain::controller& chain = app().get_plugin<chain_plugin>().chain();
    chain.commit_block();
    auto hbt = chain.head_block_time();
    //idump((fc::time_point::now() - hbt));
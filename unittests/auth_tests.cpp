@@ -518,5 +518,148 @@ BOOST_AUTO_TEST_CASE( linkauth_special ) { try {
 
 } FC_LOG_AND_RETHROW() }
 
+BOOST_AUTO_TEST_CASE( authority_cache ) { try {
+   TESTER chain;
+   chain.create_account("alice");
+   chain.produce_blocks();
+
+   const auto& authm = chain.control->get_authorization_manager();
+   const auto active_pub_key = chain.get_public_key("alice", "active");
+   const auto owner_pub_key  = chain.get_public_key("alice", "owner");
+
+   auto before = authm.get_cache_stats();
+   authm.check_authorization( N(alice), config::active_name, {active_pub_key} );
+   authm.check_authorization( N(alice), config::active_name, {active_pub_key} );
+   auto after = authm.get_cache_stats();
+   BOOST_TEST( after.misses == before.misses + 1 );
+   BOOST_TEST( after.hits == before.hits + 1 );
+
+   // a cached result still reports the keys it did not use
+   BOOST_CHECK_THROW( authm.check_authorization( N(alice), config::active_name, {active_pub_key, owner_pub_key} ), tx_irrelevant_sig );
+   BOOST_CHECK_THROW( authm.check_authorization( N(alice), config::active_name, {active_pub_key, owner_pub_key} ), tx_irrelevant_sig );
+   authm.check_authorization( N(alice), config::active_name, {active_pub_key, owner_pub_key}, {}, fc::microseconds(0),
+                              std::function<void()>(), true );
+
+   // updating the permission drops results computed from the old authority
+   const auto new_active_pub_key = chain.get_public_key("alice", "new_active");
+   chain.set_authority( N(alice), config::active_name, authority(new_active_pub_key), config::owner_name );
+   authm.check_authorization( N(alice), config::active_name, {new_active_pub_key} );
+   BOOST_CHECK_THROW( authm.check_authorization( N(alice), config::active_name, {active_pub_key} ), unsatisfied_authorization );
+
+   // so does undoing the update, which bypasses authorization_manager
+   before = authm.get_cache_stats();
+   chain.control->abort_block();
+   BOOST_CHECK_THROW( authm.check_authorization( N(alice), config::active_name, {new_active_pub_key} ), unsatisfied_authorization );
+   authm.check_authorization( N(alice), config::active_name, {active_pub_key} );
+   after = authm.get_cache_stats();
+   BOOST_TEST( after.invalidations > before.invalidations );
+
+} FC_LOG_AND_RETHROW() }
+
+BOOST_AUTO_TEST_CASE( authority_cache_same_block_undo ) { try {
+   TESTER chain;
+   chain.create_account("alice");
+   chain.produce_blocks();
+
+   auto& authm = chain.control->get_mutable_authorization_manager();
+   const auto old_pub_key = chain.get_public_key("alice", "old_active");
+   const auto new_pub_key = chain.get_public_key("alice", "new_active");
+
+   // both updates below land in the same pending block and so share last_updated
+   chain.set_authority( N(alice), config::active_name, authority(old_pub_key), config::owner_name );
+   authm.check_authorization( N(alice), config::active_name, {old_pub_key} );
+
+   {
+      // a transaction that updates the key and checks it before failing
+      auto session = chain.control->mutable_db().start_undo_session(true);
+      authm.modify_permission( authm.get_permission({N(alice), config::active_name}), authority(new_pub_key) );
+      authm.check_authorization( N(alice), config::active_name, {new_pub_key} );
+      BOOST_CHECK_THROW( authm.check_authorization( N(alice), config::active_name, {old_pub_key} ), unsatisfied_authorization );
+      session.undo();
+   }
+
+   authm.check_authorization( N(alice), config::active_name, {old_pub_key} );
+   BOOST_CHECK_THROW( authm.check_authorization( N(alice), config::active_name, {new_pub_key} ), unsatisfied_authorization );
+
+} FC_LOG_AND_RETHROW() }
+
+BOOST_AUTO_TEST_CASE( authority_cache_benchmark ) { try {
+   TESTER chain;
+   chain.create_accounts( {N(alice), N(bob), N(carol)} );
+   chain.produce_blocks();
+
+   flat_set<public_key_type> provided;
+   auto make_keys = [&]( account_name a, std::initializer_list<const char*> roles ) {
+      vector<key_weight> keys;
+      for( auto role : roles ) {
+         keys.push_back( {chain.get_public_key(a, role), 1} );
+         provided.insert( keys.back().key );
+      }
+      std::sort( keys.begin(), keys.end(), []( const auto& x, const auto& y ) { return x.key < y.key; } );
+      return keys;
+   };
+
+   // alice@active needs both of its keys and bob@active and carol@active, each satisfied by two keys
+   chain.set_authority( N(bob), config::active_name, authority( 2, make_keys(N(bob), {"k1", "k2"}) ) );
+   chain.set_authority( N(carol), config::active_name, authority( 2, make_keys(N(carol), {"k1", "k2"}) ) );
+   chain.set_authority( N(alice), config::active_name,
+                        authority( 4, make_keys(N(alice), {"k1", "k2"}),
+                                   { {{N(bob), config::active_name}, 1}, {{N(carol), config::active_name}, 1} } ) );
+   chain.produce_blocks();
+
+   auto& authm = chain.control->get_mutable_authorization_manager();
+   const auto capacity = authm.get_cache_stats().capacity;
+   const int iterations = 10000;
+   auto measure = [&]( uint32_t cache_capacity ) {
+      authm.set_cache_capacity( cache_capacity );
+      authm.check_authorization( N(alice), config::active_name, provided );
+      auto start = fc::time_point::now();
+      for( int i = 0; i < iterations; ++i )
+         authm.check_authorization( N(alice), config::active_name, provided );
+      return fc::time_point::now() - start;
+   };
+   const auto uncached = measure( 0 );
+   const auto cached = measure( 16 );
+   authm.set_cache_capacity( capacity );
+
+   BOOST_TEST_MESSAGE( "check_authorization of a two level authority with 6 keys, " << iterations << " checks: uncached "
+                       << uncached.count() << " us, cached " << cached.count() << " us" );
+
+} FC_LOG_AND_RETHROW() }
+
+BOOST_AUTO_TEST_CASE( required_keys_cache ) { try {
+   TESTER chain;
+   chain.create_accounts( {N(alice), N(bob)} );
+   chain.produce_blocks();
+
+   signed_transaction trx;
+   trx.actions.emplace_back( vector<permission_level>{{N(alice), config::active_name}, {N(bob), config::active_name}},
+                             config::system_account_name, N(reqauth), fc::raw::pack(N(alice)) );
+   trx.actions.emplace_back( vector<permission_level>{{N(alice), config::active_name}},
+                             config::system_account_name, N(reqauth), fc::raw::pack(N(bob)) );
+
+   const flat_set<public_key_type> candidates{ chain.get_public_key(N(alice), "active"), chain.get_public_key(N(alice), "owner"),
+                                               chain.get_public_key(N(bob), "active"), chain.get_public_key(N(carol), "active") };
+   const flat_set<public_key_type> expected{ chain.get_public_key(N(alice), "active"), chain.get_public_key(N(bob), "active") };
+
+   const auto& authm = chain.control->get_authorization_manager();
+   auto before = authm.get_required_keys_cache_stats();
+   const auto consensus_before = authm.get_cache_stats();
+   BOOST_TEST( authm.get_required_keys( trx, candidates ) == expected );
+   BOOST_TEST( authm.get_required_keys( trx, candidates ) == expected );
+   auto after = authm.get_required_keys_cache_stats();
+   BOOST_TEST( after.misses == before.misses + 2 );
+   BOOST_TEST( after.hits == before.hits + 2 );
+
+   // API supplied candidate keys do not touch the cache used to validate transactions
+   const auto consensus_after = authm.get_cache_stats();
+   BOOST_TEST( consensus_after.size == consensus_before.size );
+   BOOST_TEST( consensus_after.misses == consensus_before.misses );
+
+   const auto new_active_pub_key = chain.get_public_key(N(bob), "new_active");
+   chain.set_authority( N(bob), config::active_name, authority(new_active_pub_key), config::owner_name );
+   BOOST_CHECK_THROW( authm.get_required_keys( trx, candidates ), unsatisfied_authorization );
+
+} FC_LOG_AND_RETHROW() }
 
 BOOST_AUTO_TEST_SUITE_END()
@@ -5,6 +5,7 @@
 
 #include <boost/test/unit_test.hpp>
 #include <snax/testing/tester.hpp>
+#include <snax/chain/controller_metrics.hpp>
 
 using namespace snax;
 using namespace testing;
@@ -163,4 +164,79 @@ BOOST_AUTO_TEST_CASE(untrusted_producer_test)
    }) ;
 }
 
+BOOST_AUTO_TEST_CASE(controller_metrics_test)
+{
+   tester main;
+
+   const auto& metrics = main.control->get_metrics();
+   auto before = metrics.get_snapshot();
+   BOOST_REQUIRE_EQUAL( before.stages.size(), size_t(controller_metrics::stage_count) );
+
+   main.create_account(N(newacc));
+   BOOST_CHECK_THROW( main.create_account(N(newacc)), fc::exception );
+   main.produce_blocks(2);
+
+   auto after = metrics.get_snapshot();
+   BOOST_TEST( after.trx_applied == before.trx_applied + 1 );
+   BOOST_TEST( after.trx_failed == before.trx_failed + 1 );
+
+   for( auto s : { controller_metrics::start_block, controller_metrics::finalize_block, controller_metrics::commit_block,
+                   controller_metrics::push_transaction, controller_metrics::emit_accepted_block } ) {
+      const auto& h = after.stages[s];
+      BOOST_TEST_CONTEXT( h.stage ) {
+         BOOST_TEST( h.count > before.stages[s].count );
+         uint64_t total = 0;
+         for( auto b : h.buckets ) total += b;
+         BOOST_TEST( total == h.count );
+         BOOST_TEST( h.max_us <= h.sum_us );
+      }
+   }
+
+   auto text = metrics.to_prometheus();
+   BOOST_TEST( text.find( "# TYPE snax_controller_stage_duration_us histogram" ) != string::npos );
+   BOOST_TEST( text.find( "snax_controller_stage_duration_us_bucket{stage=\"commit_block\",le=\"+Inf\"}" ) != string::npos );
+   BOOST_TEST( text.find( "snax_controller_transactions_total{result=\"applied\"}" ) != string::npos );
+}
+
+BOOST_AUTO_TEST_CASE(incremental_block_merkles_test)
+{
+   tester main;
+
+   // collect the receipts of executed actions with their block, in execution order once sorted
+   vector<pair<uint32_t, action_receipt>> receipts;
+   std::function<void(uint32_t, const action_trace&)> collect = [&]( uint32_t block_num, const action_trace& at ) {
+      receipts.emplace_back( block_num, at.receipt );
+      for( const auto& inl : at.inline_traces )
+         collect( block_num, inl );
+   };
+   auto c = main.control->applied_transaction.connect( [&]( const transaction_trace_ptr& t ) {
+      if( t->except ) return;
+      for( const auto& at : t->action_traces )
+         collect( t->block_num, at );
+   });
+
+   main.produce_block(); // the next block, including its onblock action, is started with the connection in place
+   main.create_accounts( {N(alice), N(bob), N(carol)} );
+   BOOST_CHECK_THROW( main.create_account(N(alice)), fc::exception ); // rolled back, not part of the block
+   main.create_account( N(dave) );
+   auto b = main.produce_block();
+   c.disconnect();
+
+   vector<digest_type> trx_digests;
+   for( const auto& r : b->transactions )
+      trx_digests.emplace_back( r.digest() );
+   BOOST_CHECK( b->transaction_mroot == merkle( trx_digests ) );
+
+   std::sort( receipts.begin(), receipts.end(), []( const auto& l, const auto& r ) {
+      return l.second.global_sequence < r.second.global_sequence;
+   });
+   vector<digest_type> action_digests;
+   for( const auto& r : receipts ) {
+      if( r.first == b->block_num() )
+         action_digests.emplace_back( r.second.digest() );
+   }
+   BOOST_REQUIRE( action_digests.size() > 4 );
+   BOOST_CHECK( b->action_mroot == merkle( action_digests ) );
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -7,12 +7,19 @@
 #include <snax/chain/authority.hpp>
 #include <snax/chain/types.hpp>
 #include <snax/chain/asset.hpp>
+#include <snax/chain/signature_recovery_cache.hpp>
+#include <snax/chain/transaction_metadata.hpp>
+#include <snax/chain/merkle.hpp>
+#include <snax/chain/transaction_context.hpp>
+#include <snax/chain/scratch_arena.hpp>
 #include <snax/testing/tester.hpp>
 
 #include <fc/io/json.hpp>
 
 #include <boost/test/unit_test.hpp>
 
+#include <thread>
+
 #ifdef NON_VALIDATING_TEST
 #define TESTER tester
 #else
@@ -25,6 +32,27 @@ using namespace snax::testing;
 #include <boost/random/mersenne_twister.hpp>
 #include <boost/random/uniform_int_distribution.hpp>
 
+#include <cstdlib>
+#include <new>
+
+// count the heap allocations of each thread, used to measure the scratch arena
+static thread_local uint64_t thread_allocations = 0;
+
+void* operator new( std::size_t size ) {
+   ++thread_allocations;
+   if( void* p = std::malloc( size ? size : 1 ) )
+      return p;
+   throw std::bad_alloc();
+}
+
+void operator delete( void* p ) noexcept {
+   std::free( p );
+}
+
+void operator delete( void* p, std::size_t ) noexcept {
+   std::free( p );
+}
+
 namespace snax
 {
 using namespace chain;
@@ -606,6 +634,171 @@ BOOST_AUTO_TEST_CASE(transaction_test) { try {
    bytes raw2 = pkt2.get_raw_transaction();
    BOOST_CHECK_EQUAL(raw.size(), raw2.size());
 
+   // metadata shares the packed transaction instead of copying it
+   auto ptrx = std::make_shared<packed_transaction>(pkt2);
+   transaction_metadata mtrx(ptrx);
+   BOOST_CHECK(mtrx.packed_trx == ptrx);
+   BOOST_CHECK_EQUAL(trx.id(), mtrx.id);
+   BOOST_CHECK_EQUAL(trx.id(), mtrx.trx.id());
+   BOOST_CHECK_EQUAL(digest_type::hash(pkt2), mtrx.signed_id);
+   BOOST_CHECK_EQUAL(1, mtrx.trx.signatures.size());
+
+   // cached id is dropped when the packed transaction is replaced
+   trx.expiration = trx.expiration + 1;
+   pkt.set_transaction(trx, packed_transaction::none);
+   BOOST_CHECK_EQUAL(trx.id(), pkt.id());
+   BOOST_CHECK_EQUAL(true, trx.expiration == pkt.expiration());
+
+} FC_LOG_AND_RETHROW() }
+
+BOOST_AUTO_TEST_CASE(signature_recovery_cache_test) { try {
+
+   auto& cache = signature_recovery_cache::instance();
+   const chain_id_type chain_id( fc::sha256::hash(std::string("chain")).str() );
+   auto priv_key = private_key_type::regenerate<fc::ecc::private_key_shim>(fc::sha256::hash(std::string("recovery")));
+
+   signed_transaction trx;
+   trx.expiration = fc::time_point_sec( fc::time_point::now() ) + 60;
+   trx.sign( priv_key, chain_id );
+
+   flat_set<public_key_type> recovered;
+   std::thread recovering_thread( [&]() {
+      recovered = trx.get_signature_keys( chain_id );
+   });
+   recovering_thread.join();
+   BOOST_CHECK( recovered.count( priv_key.get_public_key() ) );
+
+   // key recovered on another thread is reused
+   auto before = cache.get_stats();
+   BOOST_CHECK( trx.get_signature_keys( chain_id ).count( priv_key.get_public_key() ) );
+   auto after = cache.get_stats();
+   BOOST_CHECK_EQUAL( before.hits + 1, after.hits );
+   BOOST_CHECK_EQUAL( before.misses, after.misses );
+
+   // a different digest for the same signature is not served from the cache
+   BOOST_CHECK( !trx.get_signature_keys( chain_id_type(fc::sha256::hash(std::string("other")).str()) ).count( priv_key.get_public_key() ) );
+   BOOST_CHECK_EQUAL( after.misses + 1, cache.get_stats().misses );
+
+   // entries are dropped once the transaction has expired
+   cache.remove_expired( trx.expiration + 1 );
+   before = cache.get_stats();
+   trx.get_signature_keys( chain_id );
+   BOOST_CHECK_EQUAL( before.misses + 1, cache.get_stats().misses );
+
+} FC_LOG_AND_RETHROW() }
+
+BOOST_AUTO_TEST_CASE(merkle_accumulator_test) { try {
+
+   vector<digest_type> ids;
+   merkle_accumulator acc;
+   BOOST_CHECK( acc.root() == digest_type() );
+   for( size_t n = 1; n <= 300; ++n ) {
+      ids.emplace_back( digest_type::hash( n ) );
+      acc.append( ids.back() );
+      BOOST_CHECK_EQUAL( acc.size(), n );
+      BOOST_CHECK( acc.root() == merkle( ids ) );
+   }
+
+   // a copy is a point to roll back to
+   auto saved = acc;
+   acc.append( digest_type::hash( 0 ) );
+   BOOST_CHECK( saved.root() == merkle( ids ) );
+
+} FC_LOG_AND_RETHROW() }
+
+
+#if defined(__linux__)
+BOOST_AUTO_TEST_CASE(deadline_timer_per_thread_test) { try {
+
+   // two threads with different deadlines, only the thread whose deadline passes sees it expire
+   std::atomic_bool short_expired{false}, long_expired{true}, polled{false}, done{false};
+   std::atomic<int> armed{0};
+   auto run = [&]( fc::microseconds timeout, std::atomic_bool& result ) {
+      deadline_timer timer;
+      timer.start( fc::time_point::now() + timeout );
+      if( timeout > fc::seconds(1) && timer.expired )
+         polled = true; // start() reports expired immediately when checktime is polled
+      ++armed;
+      while( !done )
+         std::this_thread::sleep_for( std::chrono::milliseconds(1) );
+      result = timer.expired.load();
+      timer.stop();
+   };
+   std::thread short_thread( run, fc::milliseconds(20), std::ref(short_expired) );
+   std::thread long_thread( run, fc::seconds(60), std::ref(long_expired) );
+   while( armed < 2 )
+      std::this_thread::yield();
+   std::this_thread::sleep_for( std::chrono::milliseconds(200) );
+   done = true;
+   short_thread.join();
+   long_thread.join();
+
+   if( polled ) {
+      BOOST_TEST_MESSAGE( "deadline timer unavailable on this host, checktime is polled" );
+      return;
+   }
+   BOOST_CHECK( short_expired );
+   BOOST_CHECK( !long_expired );
+
+} FC_LOG_AND_RETHROW() }
+#endif
+
+BOOST_AUTO_TEST_CASE(scratch_arena_test) { try {
+
+   scratch_arena arena( 64 );
+   auto* c = arena.allocate( 1, 1 );
+   auto* d = arena.allocate( sizeof(double), alignof(double) );
+   BOOST_CHECK_EQUAL( reinterpret_cast<uintptr_t>(d) % alignof(double), 0u );
+   BOOST_CHECK( c != d );
+   BOOST_CHECK_EQUAL( arena.block_count(), 1u );
+
+   // larger than a block
+   arena.allocate( 1000, 8 );
+   BOOST_CHECK_EQUAL( arena.block_count(), 2u );
+
+   scratch_vector<account_name> names{ scratch_allocator<account_name>( arena ) };
+   for( uint64_t n = 0; n < 100; ++n )
+      names.push_back( account_name( n ) );
+   BOOST_CHECK_EQUAL( names.size(), 100u );
+   BOOST_CHECK( names[42] == account_name( 42 ) );
+
+} FC_LOG_AND_RETHROW() }
+
+// allocations of apply_context's notification and inline action queues on the heap and on the
+// per-transaction scratch arena, for 100 actions that each notify 3 accounts and send 2 inline actions
+BOOST_AUTO_TEST_CASE(scratch_arena_allocation_benchmark) { try {
+
+   const uint32_t actions = 100;
+   const action inline_action( vector<permission_level>{}, N(snax.token), N(transfer), bytes() );
+
+   uint64_t before = thread_allocations;
+   for( uint32_t i = 0; i < actions; ++i ) {
+      vector<account_name> notified;
+      vector<action> inline_actions;
+      for( uint64_t n = 0; n < 3; ++n )
+         notified.push_back( account_name( n ) );
+      for( uint32_t n = 0; n < 2; ++n )
+         inline_actions.emplace_back( inline_action );
+   }
+   uint64_t heap = thread_allocations - before;
+
+   before = thread_allocations;
+   {
+      scratch_arena arena;
+      for( uint32_t i = 0; i < actions; ++i ) {
+         scratch_vector<account_name> notified{ scratch_allocator<account_name>( arena ) };
+         scratch_vector<action> inline_actions{ scratch_allocator<action>( arena ) };
+         for( uint64_t n = 0; n < 3; ++n )
+            notified.push_back( account_name( n ) );
+         for( uint32_t n = 0; n < 2; ++n )
+            inline_actions.emplace_back( inline_action );
+      }
+   }
+   uint64_t scratch = thread_allocations - before;
+
+   BOOST_TEST_MESSAGE( "allocations for " << actions << " actions, heap: " << heap << ", scratch arena: " << scratch );
+   BOOST_CHECK_LT( scratch, heap );
+
 } FC_LOG_AND_RETHROW() }
 
 BOOST_AUTO_TEST_SUITE_END()
@@ -67,9 +67,59 @@ BOOST_FIXTURE_TEST_CASE( multi_index_load, TESTER ) try {
       push_transaction(trx);
    }
 
+   signed_transaction trx3;
+   {
+      auto& trx = trx3;
+
+      action trigger_act;
+      trigger_act.account = N(multitest);
+      trigger_act.name = N(trigger);
+      trigger_act.authorization = vector<permission_level>{{N(multitest), config::active_name}};
+      trigger_act.data = abi_ser.variant_to_binary("trigger", mutable_variant_object()
+                                                   ("what", 2),
+                                                   abi_serializer_max_time
+      );
+      trx.actions.emplace_back(std::move(trigger_act));
+      set_transaction_headers(trx);
+      trx.sign(get_private_key(N(multitest), "active"), control->get_chain_id());
+      push_transaction(trx);
+   }
+
    produce_block();
    BOOST_REQUIRE_EQUAL(true, chain_has_transaction(trx1.id()));
    BOOST_REQUIRE_EQUAL(true, chain_has_transaction(trx2.id()));
+   BOOST_REQUIRE_EQUAL(true, chain_has_transaction(trx3.id()));
+
+} FC_LOG_AND_RETHROW()
+
+BOOST_FIXTURE_TEST_CASE( multi_index_shared_cache_benchmark, TESTER ) try {
+
+   produce_blocks(2);
+   create_accounts( {N(multitest)} );
+   produce_blocks(2);
+
+   set_code( N(multitest), multi_index_test_wast );
+   set_abi( N(multitest), multi_index_test_abi );
+
+   produce_blocks(1);
+
+   // the first run creates the rows, leave it out
+   push_action( N(multitest), N(trigger), N(multitest), mutable_variant_object()("what", 3) );
+   produce_block();
+
+   const int rounds = 10;
+   fc::microseconds elapsed[2];
+   for( int r = 0; r < rounds; ++r ) {
+      for( uint32_t what : {3, 4} ) {
+         auto trace = push_action( N(multitest), N(trigger), N(multitest), mutable_variant_object()("what", what) );
+         BOOST_REQUIRE( trace && !trace->except );
+         elapsed[what - 3] += trace->elapsed;
+         produce_block();
+      }
+   }
+
+   BOOST_TEST_MESSAGE( "multi_index reads through short-lived instances, average per action: private caches "
+                       << elapsed[0].count() / rounds << " us, shared cache " << elapsed[1].count() / rounds << " us" );
 
 } FC_LOG_AND_RETHROW()
 